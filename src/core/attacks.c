@@ -0,0 +1,335 @@
+#include <stdlib.h>
+#include "attacks.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#define NOT_FILE_A 0xFEFEFEFEFEFEFEFEULL
+#define NOT_FILE_H 0x7F7F7F7F7F7F7F7FULL
+
+// ************
+// scalar fills
+// ************
+
+// a direction is a shift and the mask of squares a step in it can land on
+// (without wrapping around the board's edge). the fill doubles its reach at
+// every step, so three steps cover the seven squares of the longest ray
+
+static bitboard fillUp(bitboard sliders, bitboard empty, int shift, bitboard mask)
+{
+    empty &= mask;
+    sliders |= empty & (sliders << shift);
+    empty &= empty << shift;
+    sliders |= empty & (sliders << 2 * shift);
+    empty &= empty << 2 * shift;
+    sliders |= empty & (sliders << 4 * shift);
+    return (sliders << shift) & mask;
+}
+
+static bitboard fillDown(bitboard sliders, bitboard empty, int shift, bitboard mask)
+{
+    empty &= mask;
+    sliders |= empty & (sliders >> shift);
+    empty &= empty >> shift;
+    sliders |= empty & (sliders >> 2 * shift);
+    empty &= empty >> 2 * shift;
+    sliders |= empty & (sliders >> 4 * shift);
+    return (sliders >> shift) & mask;
+}
+
+bitboard diagonalAttacks(bitboard diagonal, bitboard empty)
+{
+    return fillUp(diagonal, empty, 9, NOT_FILE_A) | fillUp(diagonal, empty, 7, NOT_FILE_H) |
+           fillDown(diagonal, empty, 7, NOT_FILE_A) | fillDown(diagonal, empty, 9, NOT_FILE_H);
+}
+
+bitboard orthogonalAttacks(bitboard orthogonal, bitboard empty)
+{
+    return fillUp(orthogonal, empty, 8, ~0ULL) | fillUp(orthogonal, empty, 1, NOT_FILE_A) |
+           fillDown(orthogonal, empty, 8, ~0ULL) | fillDown(orthogonal, empty, 1, NOT_FILE_H);
+}
+
+// **********
+// AVX2 fills
+// **********
+
+#ifdef __AVX2__
+
+// the same fill for four directions at once, one per 64 bit lane, with a
+// shift and mask per lane
+static __m256i fillUpX4(__m256i sliders, __m256i empty, __m256i shift, __m256i mask)
+{
+    __m256i shift2 = _mm256_add_epi64(shift, shift);
+    __m256i shift4 = _mm256_add_epi64(shift2, shift2);
+    empty = _mm256_and_si256(empty, mask);
+    sliders = _mm256_or_si256(sliders, _mm256_and_si256(empty, _mm256_sllv_epi64(sliders, shift)));
+    empty = _mm256_and_si256(empty, _mm256_sllv_epi64(empty, shift));
+    sliders = _mm256_or_si256(sliders, _mm256_and_si256(empty, _mm256_sllv_epi64(sliders, shift2)));
+    empty = _mm256_and_si256(empty, _mm256_sllv_epi64(empty, shift2));
+    sliders = _mm256_or_si256(sliders, _mm256_and_si256(empty, _mm256_sllv_epi64(sliders, shift4)));
+    return _mm256_and_si256(_mm256_sllv_epi64(sliders, shift), mask);
+}
+
+static __m256i fillDownX4(__m256i sliders, __m256i empty, __m256i shift, __m256i mask)
+{
+    __m256i shift2 = _mm256_add_epi64(shift, shift);
+    __m256i shift4 = _mm256_add_epi64(shift2, shift2);
+    empty = _mm256_and_si256(empty, mask);
+    sliders = _mm256_or_si256(sliders, _mm256_and_si256(empty, _mm256_srlv_epi64(sliders, shift)));
+    empty = _mm256_and_si256(empty, _mm256_srlv_epi64(empty, shift));
+    sliders = _mm256_or_si256(sliders, _mm256_and_si256(empty, _mm256_srlv_epi64(sliders, shift2)));
+    empty = _mm256_and_si256(empty, _mm256_srlv_epi64(empty, shift2));
+    sliders = _mm256_or_si256(sliders, _mm256_and_si256(empty, _mm256_srlv_epi64(sliders, shift4)));
+    return _mm256_and_si256(_mm256_srlv_epi64(sliders, shift), mask);
+}
+
+bitboard sliderAttacks(bitboard diagonal, bitboard orthogonal, bitboard empty)
+{
+    // lanes: up, right, up-right, up-left. going down the lanes are down,
+    // left, down-left, down-right, with the mirrored masks
+    const __m256i shift = _mm256_setr_epi64x(8, 1, 9, 7);
+    const __m256i upMask =
+        _mm256_setr_epi64x(~0LL, (long long)NOT_FILE_A, (long long)NOT_FILE_A, (long long)NOT_FILE_H);
+    const __m256i downMask =
+        _mm256_setr_epi64x(~0LL, (long long)NOT_FILE_H, (long long)NOT_FILE_H, (long long)NOT_FILE_A);
+    __m256i sliders = _mm256_setr_epi64x((long long)orthogonal, (long long)orthogonal, (long long)diagonal,
+                                         (long long)diagonal);
+    __m256i open = _mm256_set1_epi64x((long long)empty);
+
+    __m256i attacks =
+        _mm256_or_si256(fillUpX4(sliders, open, shift, upMask), fillDownX4(sliders, open, shift, downMask));
+    __m128i half = _mm_or_si128(_mm256_castsi256_si128(attacks), _mm256_extracti128_si256(attacks, 1));
+    return (bitboard)(_mm_cvtsi128_si64(half) | _mm_extract_epi64(half, 1));
+}
+
+#else
+
+bitboard sliderAttacks(bitboard diagonal, bitboard orthogonal, bitboard empty)
+{
+    return diagonalAttacks(diagonal, empty) | orthogonalAttacks(orthogonal, empty);
+}
+
+#endif
+
+// *****************
+// lines and x-rays
+// *****************
+
+static bitboard betweenTable[64][64];
+static bitboard lineTable[64][64];
+
+// the squares from a square to the board's edge in one direction, directions
+// d and d ^ 2 are opposite
+static bitboard rayToEdge(int from, int direction)
+{
+    const int steps[8][2] = {{0, 1}, {1, 0}, {0, -1}, {-1, 0}, {1, 1}, {-1, 1}, {-1, -1}, {1, -1}};
+    bitboard ray = 0;
+    for (int f = from % 8 + steps[direction][0], r = from / 8 + steps[direction][1]; f >= 0 && f < 8 && r >= 0 && r < 8;
+         f += steps[direction][0], r += steps[direction][1])
+    {
+        ray |= 1ULL << (r * 8 + f);
+    }
+    return ray;
+}
+
+// filled before main runs, so any thread can read the tables without setup
+__attribute__((constructor)) static void initLineTables(void)
+{
+    for (int from = 0; from < 64; from++)
+    {
+        for (int direction = 0; direction < 8; direction++)
+        {
+            bitboard ray = rayToEdge(from, direction);
+            bitboard line = ray | rayToEdge(from, direction ^ 2) | 1ULL << from;
+            for (bitboard squares = ray; squares; squares &= squares - 1)
+            {
+                int to = trailingZeros(squares);
+                betweenTable[from][to] = ray & ~rayToEdge(to, direction) & ~(1ULL << to);
+                lineTable[from][to] = line;
+            }
+        }
+    }
+}
+
+bitboard betweenSquares(int a, int b)
+{
+    return betweenTable[a][b];
+}
+
+bitboard lineThrough(int a, int b)
+{
+    return lineTable[a][b];
+}
+
+bitboard xrayAttacks(bitboard diagonal, bitboard orthogonal, bitboard occupied, bitboard blockers)
+{
+    bitboard attacks = sliderAttacks(diagonal, orthogonal, ~occupied);
+    blockers &= attacks;
+    return sliderAttacks(diagonal, orthogonal, ~(occupied ^ blockers)) & ~attacks;
+}
+
+// *******
+// leapers
+// *******
+
+bitboard knightAttacks(bitboard knights)
+{
+    bitboard sideways = SHIFT_LEFT(knights) | SHIFT_RIGHT(knights);
+    bitboard twoSideways = SHIFT_LEFT(SHIFT_LEFT(knights)) | SHIFT_RIGHT(SHIFT_RIGHT(knights));
+    return SHIFT_UP(SHIFT_UP(sideways)) | SHIFT_DOWN(SHIFT_DOWN(sideways)) | SHIFT_UP(twoSideways) |
+           SHIFT_DOWN(twoSideways);
+}
+
+bitboard kingAttacks(bitboard kings)
+{
+    bitboard row = kings | SHIFT_LEFT(kings) | SHIFT_RIGHT(kings);
+    return (row | SHIFT_UP(row) | SHIFT_DOWN(row)) & ~kings;
+}
+
+bitboard pawnAttacks(bitboard pawns, bool white)
+{
+    bitboard sideways = SHIFT_LEFT(pawns) | SHIFT_RIGHT(pawns);
+    return white ? SHIFT_UP(sideways) : SHIFT_DOWN(sideways);
+}
+
+// ***********
+// attack info
+// ***********
+
+#define KNOWN_CHECKERS 1
+#define KNOWN_PINNED 2
+#define KNOWN_DANGER 4
+
+static bitboard sideOf(board b, bool white)
+{
+    return white ? b.white : getPieces(b) & ~b.white;
+}
+
+void initAttackInfo(attackInfo *info, game position)
+{
+    info->board = position.board;
+    info->whiteToMove = position.metadata & WHITE_TO_MOVE;
+    bitboard king = position.board.king & sideOf(position.board, info->whiteToMove);
+    info->kingSquare = king ? trailingZeros(king) : -1;
+    info->known = 0;
+}
+
+bitboard getCheckers(attackInfo *info)
+{
+    if (!(info->known & KNOWN_CHECKERS))
+    {
+        // look outwards from the king as each kind of piece and keep the enemy
+        // pieces of that kind it finds
+        board b = info->board;
+        bitboard king = b.king & sideOf(b, info->whiteToMove);
+        bitboard enemy = sideOf(b, !info->whiteToMove);
+        bitboard empty = ~getPieces(b);
+        info->checkers = enemy & ((pawnAttacks(king, info->whiteToMove) & b.pawn) | (knightAttacks(king) & b.knight) |
+                                  (diagonalAttacks(king, empty) & (b.bishop | b.queen)) |
+                                  (orthogonalAttacks(king, empty) & (b.rook | b.queen)));
+        info->known |= KNOWN_CHECKERS;
+    }
+    return info->checkers;
+}
+
+bitboard getPinned(attackInfo *info)
+{
+    if (!(info->known & KNOWN_PINNED))
+    {
+        // enemy sliders the king would see through one of its own pieces pin
+        // the piece between them
+        board b = info->board;
+        bitboard own = sideOf(b, info->whiteToMove);
+        bitboard enemy = sideOf(b, !info->whiteToMove);
+        bitboard king = b.king & own;
+        info->pinned = 0;
+        if (king)
+        {
+            bitboard occupied = getPieces(b);
+            bitboard pinners = (xrayAttacks(king, 0, occupied, own) & enemy & (b.bishop | b.queen)) |
+                               (xrayAttacks(0, king, occupied, own) & enemy & (b.rook | b.queen));
+            for (; pinners; pinners &= pinners - 1)
+            {
+                info->pinned |= betweenSquares(info->kingSquare, trailingZeros(pinners)) & own;
+            }
+        }
+        info->known |= KNOWN_PINNED;
+    }
+    return info->pinned;
+}
+
+bitboard getKingDanger(attackInfo *info)
+{
+    if (!(info->known & KNOWN_DANGER))
+    {
+        board b = info->board;
+        bool white = !info->whiteToMove;
+        bitboard side = sideOf(b, white);
+        bitboard empty = ~getPieces(b) | (b.king & sideOf(b, info->whiteToMove));
+        info->kingDanger = pawnAttacks(b.pawn & side, white) | knightAttacks(b.knight & side) |
+                           sliderAttacks((b.bishop | b.queen) & side, (b.rook | b.queen) & side, empty) |
+                           kingAttacks(b.king & side);
+        info->known |= KNOWN_DANGER;
+    }
+    return info->kingDanger;
+}
+
+// ********
+// legality
+// ********
+
+static bool isLegal(attackInfo *info, game position, move move)
+{
+    board b = info->board;
+    bitboard from = 1ULL << move.original;
+    bitboard to = 1ULL << move.next;
+    if (from & b.king)
+    {
+        // castling checked the squares it passes already
+        return !(getKingDanger(info) & to);
+    }
+    bitboard checkers = getCheckers(info);
+    if (checkers & (checkers - 1))
+    {
+        return false; // double check, only the king can move
+    }
+    bool enPassant = (from & b.pawn) && !(to & getPieces(b)) && move.original % 8 != move.next % 8;
+    if (enPassant)
+    {
+        // takes two pieces off one rank at once, simply played out
+        executeMove(&position, move);
+        return !isKingAttacked(position, info->whiteToMove);
+    }
+    if (getPinned(info) & from)
+    {
+        // a pinned piece can only move along the pin, which never answers a check
+        return !checkers && (lineThrough(info->kingSquare, move.original) & to);
+    }
+    // a check is answered by taking the checker or stepping in between
+    return !checkers || (to & (checkers | betweenSquares(info->kingSquare, trailingZeros(checkers))));
+}
+
+move *getLegalMoves(game position, attackInfo *info)
+{
+    move *generated[6] = {getPawnMoves(position), getKnightMoves(position), getBishopMoves(position),
+                          getRookMoves(position), getQueenMoves(position), getKingMoves(position)};
+
+    move *legal = (move *)malloc((MAX_MOVES + 1) * sizeof(move));
+    int moveCount = 0;
+    for (int i = 0; i < 6; i++)
+    {
+        for (int j = 0; generated[i][j].original != -1; j++)
+        {
+            if (isLegal(info, position, generated[i][j]))
+            {
+                legal[moveCount] = generated[i][j];
+                moveCount++;
+            }
+        }
+        free(generated[i]);
+    }
+
+    legal[moveCount] = (move){-1, -1, 0};
+    return legal;
+}
@@ -0,0 +1,64 @@
+#ifndef MEOWL_ATTACKS_H
+#define MEOWL_ATTACKS_H
+
+#include "bitboards.h"
+
+// set-wise slider attacks: every square attacked by a whole set of sliders,
+// found with Kogge-Stone occluded fills instead of walking each piece's rays.
+// empty is the set of unoccupied squares. the attacked squares include the
+// first blocker in each direction, whichever side it belongs to
+
+// bishops (and queens) along both diagonals
+bitboard diagonalAttacks(bitboard diagonal, bitboard empty);
+// rooks (and queens) along ranks and files
+bitboard orthogonalAttacks(bitboard orthogonal, bitboard empty);
+// both at once, all eight directions. built with AVX2 (-mavx2 or -march=native),
+// four directions are filled per register, otherwise it falls back to the above
+bitboard sliderAttacks(bitboard diagonal, bitboard orthogonal, bitboard empty);
+
+// squares strictly between a and b when they share a rank, file or
+// diagonal, 0 otherwise
+bitboard betweenSquares(int a, int b);
+// the whole rank, file or diagonal through a and b, 0 if there is none
+bitboard lineThrough(int a, int b);
+// squares the sliders attack behind the first of blockers on each of their
+// rays, as if that piece were not there (not the squares attacked anyway).
+// exact for a single slider, which is how pins and discovered checks use it
+bitboard xrayAttacks(bitboard diagonal, bitboard orthogonal, bitboard occupied, bitboard blockers);
+
+// leapers and pawns, also set-wise
+bitboard knightAttacks(bitboard knights);
+bitboard kingAttacks(bitboard kings);
+bitboard pawnAttacks(bitboard pawns, bool white);
+
+// ***********
+// attack info
+// ***********
+
+// attack information about one position, each part worked out the first
+// time it is asked for and kept for everyone else at the same node (move
+// legality, mate detection, ...). set up with initAttackInfo, then read it
+// only through the functions below
+typedef struct
+{
+    board board;
+    bool whiteToMove;
+    int kingSquare;      // of the side to move, -1 if it has no king
+    uint8_t known;       // which parts have been worked out
+    bitboard checkers;   // enemy pieces giving check to the side to move
+    bitboard pinned;     // pieces of the side to move pinned to their king
+    bitboard kingDanger; // squares the side to move's king cannot step to
+} attackInfo;
+
+void initAttackInfo(attackInfo *info, game position);
+bitboard getCheckers(attackInfo *info);
+bitboard getPinned(attackInfo *info);
+// enemy attacks with the king taken off the board, so squares behind it on a
+// checking slider's line count as attacked
+bitboard getKingDanger(attackInfo *info);
+
+// legal moves of the position info was set up for, same array format as
+// getValidMoves (which calls this with a fresh attackInfo)
+move *getLegalMoves(game position, attackInfo *info);
+
+#endif
@@ -3,79 +3,9 @@
 #include <assert.h>
 #include <stdbool.h>
 #include <string.h>
-#include "raylib.h"
-#include "raymath.h"
-#include <unistd.h>
-
-#define X_WIDTH 8
-#define Y_WIDTH 8
-#define WINDOW_HEIGHT 960
-#define WINDOW_WIDTH 960
-#define BOARD_PADDING 8
-
-#define SQUARE(file, rank) (1ULL << (rank * X_WIDTH + file))
-#define SQUARE_BIT(file, rank) (rank * X_WIDTH + file)
-#define RANK(rank) (0xFFULL << (8 * (rank)))
-#define FILE(file) (0x0101010101010101ULL << (file))
-#define SHIFT_UP(bb) ((bb) << 8)
-#define SHIFT_DOWN(bb) ((bb) >> 8)
-#define SHIFT_RIGHT(bb) (((bb) << 1) & 0xFEFEFEFEFEFEFEFEULL)
-#define SHIFT_LEFT(bb) (((bb) >> 1) & 0x7F7F7F7F7F7F7F7FULL)
-
-// ****************
-// type definitions
-// ****************
-
-typedef short square;
-
-typedef struct
-{
-    square original;
-    square next;
-} move;
-
-typedef struct node node_t;
-
-typedef struct node
-{
-    move move;
-    struct node *next;
-} node;
-
-typedef struct
-{
-    node *head;
-    node *foot;
-    int length;
-} list_t;
-
-typedef uint64_t bitboard;
-
-typedef struct
-{
-    bitboard king;
-    bitboard queen;
-    bitboard rook;
-    bitboard bishop;
-    bitboard knight;
-    bitboard pawn;
-
-    bitboard white;
-    // bitboard black;
-} board;
-
-typedef struct
-{
-    board board;
-    uint8_t metadata;
-    uint16_t en_passants;
-    list_t moves;
-} game;
-
-// *******************
-// function prototypes
-// *******************
-void addMove(list_t *moveList, move move);
+#include <sys/types.h>
+#include "bitboards.h"
+#include "attacks.h"
 
 // *************************
 // bitboard/board operations
@@ -87,6 +17,17 @@ void printMove(move move)
     printf("%c%d \n", (move.next % 8) + 97, (move.next / 8) + 1);
 }
 
+// writes the move in long algebraic notation (e.g. "e2e4", "e7e8q"), out needs 6 bytes
+void moveToString(move move, char *out)
+{
+    out[0] = (move.original % 8) + 97;
+    out[1] = (move.original / 8) + 49;
+    out[2] = (move.next % 8) + 97;
+    out[3] = (move.next / 8) + 49;
+    out[4] = move.promotion;
+    out[5] = 0;
+}
+
 void printBB(bitboard bb)
 {
     for (int i = 0; i < X_WIDTH; i++)
@@ -102,8 +43,8 @@ void printBB(bitboard bb)
 board generateStartingBoard()
 {
     board empty;
-    empty.king = SQUARE(3, 0) | SQUARE(3, 7);
-    empty.queen = SQUARE(4, 0) | SQUARE(4, 7);
+    empty.king = SQUARE(4, 0) | SQUARE(4, 7);
+    empty.queen = SQUARE(3, 0) | SQUARE(3, 7);
     empty.rook = SQUARE(0, 0) | SQUARE(7, 0) | SQUARE(0, 7) | SQUARE(7, 7);
     empty.bishop = SQUARE(2, 0) | SQUARE(5, 0) | SQUARE(2, 7) | SQUARE(5, 7);
     empty.knight = SQUARE(1, 0) | SQUARE(6, 0) | SQUARE(1, 7) | SQUARE(6, 7);
@@ -268,114 +209,13 @@ short getNthSBit(bitboard bitboard, int n)
     }
     return 0;
 }
-// ***************************
-// graphics related operations
-// ***************************
-
-Vector2 getCoordinate(char file, int rank)
-{
-    int sqWidth = (WINDOW_WIDTH - 2 * BOARD_PADDING) / X_WIDTH;
-    int sqHeight = (WINDOW_HEIGHT - 2 * BOARD_PADDING) / Y_WIDTH;
-
-    return (Vector2){BOARD_PADDING + sqWidth * file, BOARD_PADDING + sqHeight * rank};
-}
-
-void drawPiece(Texture2D texture, int file, int rank)
-{
-
-    int sqWidth = (WINDOW_WIDTH - 2 * BOARD_PADDING) / X_WIDTH;
-    int sqHeight = (WINDOW_HEIGHT - 2 * BOARD_PADDING) / Y_WIDTH;
-    DrawTextureEx(texture, getCoordinate(file, rank), 0, (sqWidth + sqHeight) / 256.0, WHITE);
-    return;
-}
-
-void renderBoard(board board, Texture2D textures[13])
-{
-    for (int i = 0; i < X_WIDTH; i++)
-    {
-        for (int j = 0; j < Y_WIDTH; j++)
-        {
-            if (board.pawn >> SQUARE_BIT(j, i) & 1)
-            {
-                if (board.white >> SQUARE_BIT(j, i) & 1)
-                {
-                    drawPiece(textures[5], j, i);
-                }
-                else
-                {
-                    drawPiece(textures[11], j, i);
-                }
-            }
-            else if (board.king >> SQUARE_BIT(j, i) & 1)
-            {
-                if (board.white >> SQUARE_BIT(j, i) & 1)
-                {
-                    drawPiece(textures[0], j, i);
-                }
-                else
-                {
-                    drawPiece(textures[6], j, i);
-                }
-            }
-            else if (board.queen >> SQUARE_BIT(j, i) & 1)
-            {
-                if (board.white >> SQUARE_BIT(j, i) & 1)
-                {
-                    drawPiece(textures[1], j, i);
-                }
-                else
-                {
-                    drawPiece(textures[7], j, i);
-                }
-            }
-            else if (board.rook >> SQUARE_BIT(j, i) & 1)
-            {
-                if (board.white >> SQUARE_BIT(j, i) & 1)
-                {
-                    drawPiece(textures[2], j, i);
-                }
-                else
-                {
-                    drawPiece(textures[8], j, i);
-                }
-            }
-            else if (board.bishop >> SQUARE_BIT(j, i) & 1)
-            {
-                if (board.white >> SQUARE_BIT(j, i) & 1)
-                {
-                    drawPiece(textures[3], j, i);
-                }
-                else
-                {
-                    drawPiece(textures[9], j, i);
-                }
-            }
-            else if (board.knight >> SQUARE_BIT(j, i) & 1)
-            {
-                if (board.white >> SQUARE_BIT(j, i) & 1)
-                {
-                    drawPiece(textures[4], j, i);
-                }
-                else
-                {
-                    drawPiece(textures[10], j, i);
-                }
-            }
-            else
-            {
-                continue;
-            }
-        }
-    }
-}
-
 // ***********************
 // game related operations
 // ***********************
 
 game newGame()
 {
-    return (game){generateStartingBoard(), 1 << 7, 0, 0, 0};
+    return (game){generateStartingBoard(), WHITE_TO_MOVE | CASTLE_ALL, 0, 0, 1, {0, 0, 0}};
 }
 
 bitboard bishopMovement(bitboard bishop, bitboard blockers, short direction)
@@ -455,6 +295,7 @@ move *getBishopMoves(game game)
             int targetSq = trailingZeros(validMoves);
             moves[moveCount].original = (square){SQUARE_BIT(bishopFile, bishopRank)};
             moves[moveCount].next = (square){SQUARE_BIT(targetSq % 8, targetSq / 8)};
+            moves[moveCount].promotion = 0;
             moveCount++;
             validMoves &= validMoves - 1;
         }
@@ -541,6 +382,7 @@ move *getRookMoves(game game)
             int targetSq = trailingZeros(validMoves);
             moves[moveCount].original = (square){SQUARE_BIT(rookFile, rookRank)};
             moves[moveCount].next = (square){SQUARE_BIT(targetSq % 8, targetSq / 8)};
+            moves[moveCount].promotion = 0;
             moveCount++;
             validMoves &= validMoves - 1;
         }
@@ -627,6 +469,7 @@ move *getKnightMoves(game game)
             int targetSq = trailingZeros(validMoves);
             moves[moveCount].original = (square){SQUARE_BIT(knightFile, knightRank)};
             moves[moveCount].next = (square){SQUARE_BIT(targetSq % 8, targetSq / 8)};
+            moves[moveCount].promotion = 0;
             moveCount++;
             validMoves &= validMoves - 1;
         }
@@ -730,6 +573,7 @@ move *getQueenMoves(game game)
             int targetSq = trailingZeros(validMoves);
             moves[moveCount].original = (square){SQUARE_BIT(queenFile, queenRank)};
             moves[moveCount].next = (square){SQUARE_BIT(targetSq % 8, targetSq / 8)};
+            moves[moveCount].promotion = 0;
             moveCount++;
             validMoves &= validMoves - 1;
         }
@@ -807,7 +651,7 @@ move *getKingMoves(game game)
         isWhite = false;
     }
 
-    int maxMoves = 8;
+    int maxMoves = 10; // 8 steps + 2 castles
     move *moves = (move *)malloc((maxMoves + 1) * sizeof(move));
     int moveCount = 0;
 
@@ -828,11 +672,41 @@ move *getKingMoves(game game)
             int targetSq = trailingZeros(validMoves);
             moves[moveCount].original = (square){SQUARE_BIT(kingFile, kingRank)};
             moves[moveCount].next = (square){SQUARE_BIT(targetSq % 8, targetSq / 8)};
+            moves[moveCount].promotion = 0;
             moveCount++;
             validMoves &= validMoves - 1;
         }
     }
 
+    // castling: the squares between king and rook must be empty and the king
+    // may not start on, pass through or land on an attacked square
+    short homeRank = isWhite ? 0 : 7;
+    uint8_t kingSide = isWhite ? CASTLE_WHITE_KING : CASTLE_BLACK_KING;
+    uint8_t queenSide = isWhite ? CASTLE_WHITE_QUEEN : CASTLE_BLACK_QUEEN;
+    if ((game.metadata & (kingSide | queenSide)) && (kings & SQUARE(4, homeRank)))
+    {
+        board b = game.board;
+        bitboard rooks = b.rook & friendlyPieces;
+        bool enemy = !isWhite;
+        bool kingSafe = !isSquareAttacked(b, SQUARE_BIT(4, homeRank), enemy);
+        if (kingSafe && (game.metadata & kingSide) && (rooks & SQUARE(7, homeRank)) &&
+            !(allPieces & (SQUARE(5, homeRank) | SQUARE(6, homeRank))) &&
+            !isSquareAttacked(b, SQUARE_BIT(5, homeRank), enemy) &&
+            !isSquareAttacked(b, SQUARE_BIT(6, homeRank), enemy))
+        {
+            moves[moveCount] = (move){SQUARE_BIT(4, homeRank), SQUARE_BIT(6, homeRank), 0};
+            moveCount++;
+        }
+        if (kingSafe && (game.metadata & queenSide) && (rooks & SQUARE(0, homeRank)) &&
+            !(allPieces & (SQUARE(1, homeRank) | SQUARE(2, homeRank) | SQUARE(3, homeRank))) &&
+            !isSquareAttacked(b, SQUARE_BIT(2, homeRank), enemy) &&
+            !isSquareAttacked(b, SQUARE_BIT(3, homeRank), enemy))
+        {
+            moves[moveCount] = (move){SQUARE_BIT(4, homeRank), SQUARE_BIT(2, homeRank), 0};
+            moveCount++;
+        }
+    }
+
     moves[moveCount].original = (square){-1};
     return moves;
 }
@@ -840,14 +714,17 @@ move *getKingMoves(game game)
 bitboard pawnMovement(bitboard pawn, bitboard enemyPieces, bitboard friendlyPieces, bool isWhite, uint16_t *metadata)
 {
     bitboard attacks = 0;
+    bitboard epTargets = 0;
 
     if (isWhite == true)
     {
-        if (SHIFT_UP(SHIFT_LEFT(pawn)) & enemyPieces)
+        // squares skipped by a black pawn double push last move
+        epTargets = (bitboard)(*metadata >> 8 & 0xFF) << 40;
+        if (SHIFT_UP(SHIFT_LEFT(pawn)) & (enemyPieces | epTargets))
         {
             attacks |= SHIFT_UP(SHIFT_LEFT(pawn));
         }
-        if (SHIFT_UP(SHIFT_RIGHT(pawn)) & enemyPieces)
+        if (SHIFT_UP(SHIFT_RIGHT(pawn)) & (enemyPieces | epTargets))
         {
             attacks |= SHIFT_UP(SHIFT_RIGHT(pawn));
         }
@@ -858,17 +735,17 @@ bitboard pawnMovement(bitboard pawn, bitboard enemyPieces, bitboard friendlyPiec
             if (!(SHIFT_UP(SHIFT_UP(pawn)) & (friendlyPieces | enemyPieces)) && pawn <= SQUARE(7, 1))
             {
                 attacks |= SHIFT_UP(SHIFT_UP(pawn));
-                *metadata |= (1 << FILE(pawn));
             }
         }
     }
     else
     {
-        if (SHIFT_DOWN(SHIFT_LEFT(pawn)) & enemyPieces)
+        epTargets = (bitboard)(*metadata & 0xFF) << 16;
+        if (SHIFT_DOWN(SHIFT_LEFT(pawn)) & (enemyPieces | epTargets))
         {
             attacks |= SHIFT_DOWN(SHIFT_LEFT(pawn));
         }
-        if (SHIFT_DOWN(SHIFT_RIGHT(pawn)) & enemyPieces)
+        if (SHIFT_DOWN(SHIFT_RIGHT(pawn)) & (enemyPieces | epTargets))
         {
             attacks |= SHIFT_DOWN(SHIFT_RIGHT(pawn));
         }
@@ -879,7 +756,6 @@ bitboard pawnMovement(bitboard pawn, bitboard enemyPieces, bitboard friendlyPiec
             if (!(SHIFT_DOWN(SHIFT_DOWN(pawn)) & (friendlyPieces | enemyPieces)) && pawn >= SQUARE(0, 6))
             {
                 attacks |= SHIFT_DOWN(SHIFT_DOWN(pawn));
-                *metadata |= 1 << (FILE(pawn) + 7);
             }
         }
     }
@@ -907,7 +783,7 @@ move *getPawnMoves(game game)
         isWhite = false;
     }
 
-    int maxMoves = numSignificantBits(pawns) * 4; // each pawn: up to 2 pushes + 2 captures
+    int maxMoves = numSignificantBits(pawns) * 12; // each pawn: up to 3 targets, 4 promotions each
     move *moves = (move *)malloc((maxMoves + 1) * sizeof(move));
     int moveCount = 0;
 
@@ -923,9 +799,22 @@ move *getPawnMoves(game game)
         while (validMoves > 0)
         {
             int targetSq = trailingZeros(validMoves);
-            moves[moveCount].original = (square){SQUARE_BIT(pawnFile, pawnRank)};
-            moves[moveCount].next = (square){SQUARE_BIT(targetSq % 8, targetSq / 8)};
-            moveCount++;
+            if (targetSq / 8 == 7 || targetSq / 8 == 0)
+            {
+                const char *promotions = "qrbn";
+                for (int i = 0; i < 4; i++)
+                {
+                    moves[moveCount] = (move){SQUARE_BIT(pawnFile, pawnRank), targetSq, promotions[i]};
+                    moveCount++;
+                }
+            }
+            else
+            {
+                moves[moveCount].original = (square){SQUARE_BIT(pawnFile, pawnRank)};
+                moves[moveCount].next = (square){SQUARE_BIT(targetSq % 8, targetSq / 8)};
+                moves[moveCount].promotion = 0;
+                moveCount++;
+            }
             validMoves &= validMoves - 1;
         }
     }
@@ -935,47 +824,189 @@ move *getPawnMoves(game game)
     return moves;
 }
 
+// every square a side attacks, found with set-wise shifts and fills for all of its pieces
+bitboard getAttackedSquares(board board, bool byWhite)
+{
+    bitboard allPieces = getPieces(board);
+    bitboard colour = byWhite ? board.white : allPieces & ~board.white;
+    // sliders are filled as whole sets too, the fills stop at the first blocker
+    return pawnAttacks(board.pawn & colour, byWhite) | knightAttacks(board.knight & colour) |
+           kingAttacks(board.king & colour) |
+           sliderAttacks((board.bishop | board.queen) & colour, (board.rook | board.queen) & colour, ~allPieces);
+}
+
+// target is a single square, as a bitboard
+static bool isTargetAttacked(board board, bitboard target, bool byWhite)
+{
+    bitboard colour = byWhite ? board.white : getPieces(board) & ~board.white;
+    bitboard empty = ~getPieces(board);
+    // cheapest lookups first
+    return (pawnAttacks(target, !byWhite) & board.pawn & colour) || (knightAttacks(target) & board.knight & colour) ||
+           (kingAttacks(target) & board.king & colour) ||
+           (orthogonalAttacks(target, empty) & (board.rook | board.queen) & colour) ||
+           (diagonalAttacks(target, empty) & (board.bishop | board.queen) & colour);
+}
+
+bool isSquareAttacked(board board, int sq, bool byWhite)
+{
+    return isTargetAttacked(board, 1ULL << sq, byWhite);
+}
+
+bool isKingAttacked(game game, bool isWhite)
+{
+    bitboard colour = isWhite ? game.board.white : getPieces(game.board) & ~game.board.white;
+    bitboard king = game.board.king & colour;
+    return king && isTargetAttacked(game.board, king, !isWhite);
+}
+
+bool inCheck(game game)
+{
+    return isKingAttacked(game, game.metadata & WHITE_TO_MOVE);
+}
+
 void executeMove(game *game, move move)
 {
+    bitboard from = 1ULL << move.original;
+    bitboard to = 1ULL << move.next;
+    bool isWhite = game->board.white & from;
+    bool isPawn = game->board.pawn & from;
+    bool isKing = game->board.king & from;
 
-    if (game->board.white & 1ULL << move.original)
+    // fifty move rule counter, reset by pawn moves and captures
+    if (isPawn || (getPieces(game->board) & to))
+    {
+        game->halfmove_clock = 0;
+    }
+    else if (game->halfmove_clock < 255)
     {
-        game->board.white ^= 1ULL << move.original;
-        game->board.white ^= 1ULL << move.next;
+        game->halfmove_clock++;
+    }
+    if (!isWhite)
+    {
+        game->fullmove_number++;
     }
 
-    if (game->board.queen & 1ULL << move.original)
+    // en passant, a diagonal pawn move onto an empty square
+    if (isPawn && (move.original % 8 != move.next % 8) && !(getPieces(game->board) & to))
     {
-        game->board.queen ^= 1ULL << move.original;
-        game->board.queen |= 1ULL << move.next;
+        bitboard captured = isWhite ? SHIFT_DOWN(to) : SHIFT_UP(to);
+        game->board.pawn &= ~captured;
+        game->board.white &= ~captured;
     }
-    else if (game->board.king & 1ULL << move.original)
+
+    // clear whatever is being captured
+    game->board.king &= ~to;
+    game->board.queen &= ~to;
+    game->board.rook &= ~to;
+    game->board.bishop &= ~to;
+    game->board.knight &= ~to;
+    game->board.pawn &= ~to;
+    game->board.white &= ~to;
+
+    if (isWhite)
     {
-        game->board.king ^= 1ULL << move.original;
-        game->board.king |= 1ULL << move.next;
+        game->board.white ^= from;
+        game->board.white |= to;
     }
-    else if (game->board.pawn & 1ULL << move.original)
+
+    if (game->board.queen & from)
+    {
+        game->board.queen ^= from;
+        game->board.queen |= to;
+    }
+    else if (game->board.king & from)
     {
-        game->board.pawn ^= 1ULL << move.original;
-        game->board.pawn |= 1ULL << move.next;
+        game->board.king ^= from;
+        game->board.king |= to;
     }
-    else if (game->board.rook & 1ULL << move.original)
+    else if (game->board.pawn & from)
     {
-        game->board.rook ^= 1ULL << move.original;
-        game->board.rook |= 1ULL << move.next;
+        game->board.pawn ^= from;
+        game->board.pawn |= to;
     }
-    else if (game->board.bishop & 1ULL << move.original)
+    else if (game->board.rook & from)
     {
-        game->board.bishop ^= 1ULL << move.original;
-        game->board.bishop |= 1ULL << move.next;
+        game->board.rook ^= from;
+        game->board.rook |= to;
     }
-    else if (game->board.knight & 1ULL << move.original)
+    else if (game->board.bishop & from)
     {
-        game->board.knight ^= 1ULL << move.original;
-        game->board.knight |= 1ULL << move.next;
+        game->board.bishop ^= from;
+        game->board.bishop |= to;
+    }
+    else if (game->board.knight & from)
+    {
+        game->board.knight ^= from;
+        game->board.knight |= to;
     }
 
-    game->metadata ^= 1 << 7;
+    if (move.promotion)
+    {
+        game->board.pawn &= ~to;
+        if (move.promotion == 'q')
+        {
+            game->board.queen |= to;
+        }
+        else if (move.promotion == 'r')
+        {
+            game->board.rook |= to;
+        }
+        else if (move.promotion == 'b')
+        {
+            game->board.bishop |= to;
+        }
+        else if (move.promotion == 'n')
+        {
+            game->board.knight |= to;
+        }
+    }
+
+    // castling, the king moves two squares and the rook jumps over it
+    if (isKing && (move.next - move.original == 2 || move.original - move.next == 2))
+    {
+        short rank = move.original / 8;
+        bitboard rookFrom = move.next > move.original ? SQUARE(7, rank) : SQUARE(0, rank);
+        bitboard rookTo = move.next > move.original ? SQUARE(5, rank) : SQUARE(3, rank);
+        game->board.rook ^= rookFrom | rookTo;
+        if (isWhite)
+        {
+            game->board.white ^= rookFrom | rookTo;
+        }
+    }
+
+    // moving the king or a rook, or capturing a rook, loses castling rights
+    if ((from | to) & SQUARE(4, 0))
+    {
+        game->metadata &= ~(CASTLE_WHITE_KING | CASTLE_WHITE_QUEEN);
+    }
+    if ((from | to) & SQUARE(4, 7))
+    {
+        game->metadata &= ~(CASTLE_BLACK_KING | CASTLE_BLACK_QUEEN);
+    }
+    if ((from | to) & SQUARE(7, 0))
+    {
+        game->metadata &= ~CASTLE_WHITE_KING;
+    }
+    if ((from | to) & SQUARE(0, 0))
+    {
+        game->metadata &= ~CASTLE_WHITE_QUEEN;
+    }
+    if ((from | to) & SQUARE(7, 7))
+    {
+        game->metadata &= ~CASTLE_BLACK_KING;
+    }
+    if ((from | to) & SQUARE(0, 7))
+    {
+        game->metadata &= ~CASTLE_BLACK_QUEEN;
+    }
+
+    game->en_passants = 0;
+    if (isPawn && (move.next - move.original == 16 || move.original - move.next == 16))
+    {
+        game->en_passants = 1 << (move.original % 8 + (isWhite ? 0 : 8));
+    }
+
+    game->metadata ^= WHITE_TO_MOVE;
 }
 
 void addMove(list_t *moveList, move move)
@@ -1001,112 +1032,19 @@ void addMove(list_t *moveList, move move)
 
 int getNumValidMoves(game game)
 {
+    move *moves = getValidMoves(game);
     int rval = 0;
-    int count = 0;
-    while ((getPawnMoves(game))[count].original != -1)
-    {
-        count++;
-        rval++;
-    }
-    count = 0;
-    while ((getKingMoves(game))[count].original != -1)
-    {
-        count++;
-        rval++;
-    }
-    count = 0;
-    while ((getRookMoves(game))[count].original != -1)
-    {
-        count++;
-        rval++;
-    }
-    count = 0;
-    while ((getKnightMoves(game))[count].original != -1)
-    {
-        count++;
-        rval++;
-    }
-    count = 0;
-    while ((getQueenMoves(game))[count].original != -1)
-    {
-        count++;
-        rval++;
-    }
-    count = 0;
-    while ((getBishopMoves(game))[count].original != -1)
+    while (moves[rval].original != -1)
     {
-        count++;
         rval++;
     }
-    count = 0;
+    free(moves);
     return rval;
 }
 
 move *getValidMoves(game game)
 {
-    move *rval = 0;
-}
-// *************************
-// engine related operations
-// *************************
-
-int main(void)
-{
-    ChangeDirectory("/Applications/Developer/meowl");
-
-    InitWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Meowl Chess");
-
-    Texture2D wk = LoadTexture("res/pieces-basic-png/white-king.png");
-    Texture2D wq = LoadTexture("res/pieces-basic-png/white-queen.png");
-    Texture2D wr = LoadTexture("res/pieces-basic-png/white-rook.png");
-    Texture2D wb = LoadTexture("res/pieces-basic-png/white-bishop.png");
-    Texture2D wn = LoadTexture("res/pieces-basic-png/white-knight.png");
-    Texture2D wp = LoadTexture("res/pieces-basic-png/white-pawn.png");
-
-    Texture2D bk = LoadTexture("res/pieces-basic-png/black-king.png");
-    Texture2D bq = LoadTexture("res/pieces-basic-png/black-queen.png");
-    Texture2D br = LoadTexture("res/pieces-basic-png/black-rook.png");
-    Texture2D bb = LoadTexture("res/pieces-basic-png/black-bishop.png");
-    Texture2D bn = LoadTexture("res/pieces-basic-png/black-knight.png");
-    Texture2D bp = LoadTexture("res/pieces-basic-png/black-pawn.png");
-
-    Texture2D boardTexture = LoadTexture("res/pieces-basic-png/rect-8x8.png");
-
-    Texture2D textures[13] = {wk, wq, wr, wb, wn, wp, bk, bq, br, bb, bn, bp, boardTexture};
-    game game = newGame();
-
-    game.moves.head = 0;
-    game.moves.foot = 0;
-
-    move *moves = getPawnMoves(game);
-    executeMove(&game, moves[1]);
-    move *moves2 = getPawnMoves(game);
-    executeMove(&game, moves2[3]);
-
-    int moveCount = 0;
-    while (moves2[moveCount].original != -1)
-    {
-        printf("%d :", moveCount);
-        printMove(moves2[moveCount]);
-        moveCount++;
-    }
-
-    while (!WindowShouldClose())
-    {
-        BeginDrawing();
-        ClearBackground(WHITE);
-        DrawTextureEx(boardTexture, (Vector2){0.0, 0.0}, 0, (float)(WINDOW_HEIGHT + WINDOW_WIDTH) / 1568, WHITE);
-        renderBoard(game.board, textures);
-        executeMove(&game, (move){SQUARE_BIT(0, 1), SQUARE_BIT(0, 3)});
-        EndDrawing();
-    }
-
-    for (int i = 0; i < sizeof(textures) / sizeof(Texture2D); i++)
-    {
-        UnloadTexture(textures[i]);
-    }
-
-    CloseWindow();
-
-    return 0;
+    attackInfo info;
+    initAttackInfo(&info, game);
+    return getLegalMoves(game, &info);
 }
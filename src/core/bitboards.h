@@ -0,0 +1,131 @@
+#ifndef MEOWL_BITBOARDS_H
+#define MEOWL_BITBOARDS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define X_WIDTH 8
+#define Y_WIDTH 8
+#define MAX_MOVES 256
+
+#define SQUARE(file, rank) (1ULL << (rank * X_WIDTH + file))
+#define SQUARE_BIT(file, rank) (rank * X_WIDTH + file)
+#define RANK(rank) (0xFFULL << (8 * (rank)))
+#define FILE(file) (0x0101010101010101ULL << (file))
+#define SHIFT_UP(bb) ((bb) << 8)
+#define SHIFT_DOWN(bb) ((bb) >> 8)
+#define SHIFT_RIGHT(bb) (((bb) << 1) & 0xFEFEFEFEFEFEFEFEULL)
+#define SHIFT_LEFT(bb) (((bb) >> 1) & 0x7F7F7F7F7F7F7F7FULL)
+
+// game.metadata bits
+#define WHITE_TO_MOVE (1 << 7)
+#define CASTLE_WHITE_KING (1 << 0)
+#define CASTLE_WHITE_QUEEN (1 << 1)
+#define CASTLE_BLACK_KING (1 << 2)
+#define CASTLE_BLACK_QUEEN (1 << 3)
+#define CASTLE_ALL (CASTLE_WHITE_KING | CASTLE_WHITE_QUEEN | CASTLE_BLACK_KING | CASTLE_BLACK_QUEEN)
+
+// ****************
+// type definitions
+// ****************
+
+typedef short square;
+
+typedef struct
+{
+    square original;
+    square next;
+    char promotion; // 'q', 'r', 'b', 'n' or 0
+} move;
+
+typedef struct node node_t;
+
+typedef struct node
+{
+    move move;
+    struct node *next;
+} node;
+
+typedef struct
+{
+    node *head;
+    node *foot;
+    int length;
+} list_t;
+
+typedef uint64_t bitboard;
+
+typedef struct
+{
+    bitboard king;
+    bitboard queen;
+    bitboard rook;
+    bitboard bishop;
+    bitboard knight;
+    bitboard pawn;
+
+    bitboard white;
+    // bitboard black;
+} board;
+
+typedef struct
+{
+    board board;
+    uint8_t metadata;     // bit 7: white to move, bits 0-3: castling rights
+    uint16_t en_passants; // bit f: white pawn on file f just moved two squares, bit f + 8: black pawn
+    uint8_t halfmove_clock;
+    uint16_t fullmove_number;
+    list_t moves;
+} game;
+
+// *************************
+// bitboard/board operations
+// *************************
+
+void printMove(move move);
+void moveToString(move move, char *out);
+void printBB(bitboard bb);
+board generateStartingBoard();
+void printBoard(board board);
+int numSignificantBits(bitboard bitboard);
+int trailingZeros(bitboard bitboard);
+bitboard getPieces(board board);
+short *getPieceSquares(bitboard bitboard);
+short getNthSBit(bitboard bitboard, int n);
+
+// ***********************
+// game related operations
+// ***********************
+
+game newGame();
+
+bitboard bishopMovement(bitboard bishop, bitboard blockers, short direction);
+bitboard rookMovement(bitboard rook, bitboard blockers, int direction);
+bitboard knightMovement(bitboard knight, bitboard blockers, short direction);
+bitboard queenMovement(bitboard queen, bitboard blockers, short direction);
+bitboard kingMovement(bitboard king, bitboard blockers, short direction);
+bitboard pawnMovement(bitboard pawn, bitboard enemyPieces, bitboard friendlyPieces, bool isWhite, uint16_t *metadata);
+
+// each generator returns a malloc'd array terminated by a move with original == -1
+move *getBishopMoves(game game);
+move *getRookMoves(game game);
+move *getKnightMoves(game game);
+move *getQueenMoves(game game);
+move *getKingMoves(game game);
+move *getPawnMoves(game game);
+
+bitboard getAttackedSquares(board board, bool byWhite);
+// looks outwards from sq as each kind of piece instead of generating the
+// attacker's moves, so it costs the same whatever the position
+bool isSquareAttacked(board board, int sq, bool byWhite);
+bool isKingAttacked(game game, bool isWhite);
+// whether the side to move is in check
+bool inCheck(game game);
+
+void executeMove(game *game, move move);
+void addMove(list_t *moveList, move move);
+int getNumValidMoves(game game);
+// legal moves only, same array format as the piece generators
+move *getValidMoves(game game);
+
+#endif
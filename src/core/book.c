@@ -0,0 +1,170 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "book.h"
+#include "zobrist.h"
+
+#define BOOK_ENTRY_SIZE 16
+
+bool openBook(openingBook *book, const char *path)
+{
+    book->data = NULL;
+    book->size = 0;
+    book->entries = 0;
+    if (book->seed == 0)
+    {
+        book->seed = 0x9E3779B97F4A7C15ULL;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < BOOK_ENTRY_SIZE)
+    {
+        close(fd);
+        return false;
+    }
+    void *data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+    // probes jump around the file, readahead would only waste page cache
+    madvise(data, info.st_size, MADV_RANDOM);
+
+    book->data = (const uint8_t *)data;
+    book->size = info.st_size;
+    book->entries = info.st_size / BOOK_ENTRY_SIZE;
+    return true;
+}
+
+void closeBook(openingBook *book)
+{
+    if (book->data != NULL)
+    {
+        munmap((void *)book->data, book->size);
+    }
+    book->data = NULL;
+    book->size = 0;
+    book->entries = 0;
+}
+
+// ***************
+// entry accessors
+// ***************
+
+static uint64_t readBigEndian(const uint8_t *bytes, int count)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < count; i++)
+    {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+static uint64_t entryKey(const openingBook *book, size_t index)
+{
+    return readBigEndian(book->data + index * BOOK_ENTRY_SIZE, 8);
+}
+
+static uint16_t entryMove(const openingBook *book, size_t index)
+{
+    return (uint16_t)readBigEndian(book->data + index * BOOK_ENTRY_SIZE + 8, 2);
+}
+
+static uint16_t entryWeight(const openingBook *book, size_t index)
+{
+    return (uint16_t)readBigEndian(book->data + index * BOOK_ENTRY_SIZE + 10, 2);
+}
+
+// Polyglot moves: to file bits 0-2, to rank 3-5, from file 6-8, from rank 9-11,
+// promotion 12-14 (none, n, b, r, q). castling is stored as king takes rook
+static move decodeMove(game game, uint16_t encoded)
+{
+    square next = (square)(((encoded >> 3) & 7) * 8 + (encoded & 7));
+    square original = (square)(((encoded >> 9) & 7) * 8 + ((encoded >> 6) & 7));
+    int promotion = (encoded >> 12) & 7;
+    const char promotions[] = {0, 'n', 'b', 'r', 'q', 0, 0, 0};
+
+    if ((game.board.king >> original & 1) && original % 8 == 4 && original / 8 == next / 8)
+    {
+        if (next % 8 == 7)
+        {
+            next = original + 2;
+        }
+        else if (next % 8 == 0)
+        {
+            next = original - 2;
+        }
+    }
+    return (move){original, next, promotions[promotion]};
+}
+
+// ****
+// probe
+// ****
+
+move probeBook(openingBook *book, game game)
+{
+    move none = (move){-1, -1, 0};
+    if (book->data == NULL)
+    {
+        return none;
+    }
+
+    // binary search for the first entry with this key
+    uint64_t key = getPositionKey(game);
+    size_t low = 0;
+    size_t high = book->entries;
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        if (entryKey(book, middle) < key)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    if (low >= book->entries || entryKey(book, low) != key)
+    {
+        return none;
+    }
+
+    uint32_t totalWeight = 0;
+    size_t end = low;
+    for (; end < book->entries && entryKey(book, end) == key; end++)
+    {
+        totalWeight += entryWeight(book, end);
+    }
+    if (totalWeight == 0)
+    {
+        return decodeMove(game, entryMove(book, low));
+    }
+
+    // xorshift64, cheap and good enough to spread choices
+    book->seed ^= book->seed << 13;
+    book->seed ^= book->seed >> 7;
+    book->seed ^= book->seed << 17;
+    uint32_t pick = (uint32_t)(book->seed % totalWeight);
+    for (size_t i = low; i < end; i++)
+    {
+        uint16_t weight = entryWeight(book, i);
+        if (pick < weight)
+        {
+            return decodeMove(game, entryMove(book, i));
+        }
+        pick -= weight;
+    }
+    return decodeMove(game, entryMove(book, low));
+}
@@ -0,0 +1,25 @@
+#ifndef MEOWL_BOOK_H
+#define MEOWL_BOOK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "bitboards.h"
+
+// a Polyglot .bin opening book, memory mapped. entries are 16 bytes, big endian
+// (key, move, weight, learn) and sorted by key
+typedef struct
+{
+    const uint8_t *data;
+    size_t size;
+    size_t entries;
+    uint64_t seed; // for the weighted random choice
+} openingBook;
+
+bool openBook(openingBook *book, const char *path);
+void closeBook(openingBook *book);
+
+// picks one of the position's book moves at random, weighted by the entry weights.
+// does not allocate; returns a move with original == -1 if the position is not in the book
+move probeBook(openingBook *book, game game);
+
+#endif
@@ -0,0 +1,255 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "dataset.h"
+
+_Static_assert(sizeof(datasetHeader) == 64, "datasetHeader must stay 64 bytes");
+_Static_assert(sizeof(datasetChunk) == 24, "datasetChunk must stay 24 bytes");
+
+// *******
+// reading
+// *******
+
+static bool validDataset(const uint8_t *data, size_t size)
+{
+    const datasetHeader *header = (const datasetHeader *)data;
+    if (size < sizeof(datasetHeader) || memcmp(header->magic, DATASET_MAGIC, 8) != 0 ||
+        header->version != DATASET_VERSION || header->recordSize != sizeof(trainingRecord) ||
+        header->indexOffset > size || header->chunkCount > (size - header->indexOffset) / sizeof(datasetChunk))
+    {
+        return false;
+    }
+    const datasetChunk *chunks = (const datasetChunk *)(data + header->indexOffset);
+    uint64_t first = 0;
+    for (uint64_t i = 0; i < header->chunkCount; i++)
+    {
+        if (chunks[i].first != first || chunks[i].offset < sizeof(datasetHeader) ||
+            chunks[i].offset + (uint64_t)chunks[i].count * sizeof(trainingRecord) > header->indexOffset)
+        {
+            return false;
+        }
+        first += chunks[i].count;
+    }
+    return first == header->recordCount;
+}
+
+bool openDataset(dataset *set, const char *path)
+{
+    memset(set, 0, sizeof(*set));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(datasetHeader))
+    {
+        close(fd);
+        return false;
+    }
+    void *data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+    if (!validDataset((const uint8_t *)data, info.st_size))
+    {
+        munmap(data, info.st_size);
+        return false;
+    }
+
+    const datasetHeader *header = (const datasetHeader *)data;
+    set->data = (const uint8_t *)data;
+    set->size = info.st_size;
+    set->chunks = (const datasetChunk *)(set->data + header->indexOffset);
+    set->count = header->recordCount;
+    set->chunkCount = header->chunkCount;
+    return true;
+}
+
+void closeDataset(dataset *set)
+{
+    if (set->data != NULL)
+    {
+        munmap((void *)set->data, set->size);
+    }
+    memset(set, 0, sizeof(*set));
+}
+
+const trainingRecord *datasetRecord(const dataset *set, uint64_t index)
+{
+    // last chunk starting at or before index
+    uint64_t low = 0;
+    uint64_t high = set->chunkCount - 1;
+    while (low < high)
+    {
+        uint64_t middle = (low + high + 1) / 2;
+        if (set->chunks[middle].first <= index)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle - 1;
+        }
+    }
+    const datasetChunk *chunk = &set->chunks[low];
+    return (const trainingRecord *)(set->data + chunk->offset) + (index - chunk->first);
+}
+
+const trainingRecord *sampleDataset(const dataset *set, uint64_t *random)
+{
+    // xorshift64*
+    *random ^= *random >> 12;
+    *random ^= *random << 25;
+    *random ^= *random >> 27;
+    return datasetRecord(set, (*random * 0x2545F4914F6CDD1DULL) % set->count);
+}
+
+typedef struct
+{
+    const dataset *set;
+    datasetVisitor visit;
+    void *data;
+    atomic_ullong next;
+} datasetScan;
+
+typedef struct
+{
+    datasetScan *scan;
+    int thread;
+} datasetScanWorker;
+
+static void *scanWorker(void *data)
+{
+    datasetScanWorker *worker = (datasetScanWorker *)data;
+    datasetScan *scan = worker->scan;
+    uint64_t index;
+    while ((index = atomic_fetch_add(&scan->next, 1)) < scan->set->chunkCount)
+    {
+        const datasetChunk *chunk = &scan->set->chunks[index];
+        scan->visit((const trainingRecord *)(scan->set->data + chunk->offset), chunk->count, worker->thread,
+                    scan->data);
+    }
+    return NULL;
+}
+
+void scanDataset(const dataset *set, int threads, datasetVisitor visit, void *data)
+{
+    if (threads < 1)
+    {
+        threads = 1;
+    }
+    // every chunk is read once from start to end
+    madvise((void *)set->data, set->size, MADV_SEQUENTIAL);
+    datasetScan scan = {set, visit, data, 0};
+    atomic_init(&scan.next, 0);
+    pthread_t *handles = (pthread_t *)malloc(threads * sizeof(pthread_t));
+    datasetScanWorker *workers = (datasetScanWorker *)malloc(threads * sizeof(datasetScanWorker));
+    for (int i = 0; i < threads; i++)
+    {
+        workers[i] = (datasetScanWorker){&scan, i};
+        pthread_create(&handles[i], NULL, scanWorker, &workers[i]);
+    }
+    for (int i = 0; i < threads; i++)
+    {
+        pthread_join(handles[i], NULL);
+    }
+    madvise((void *)set->data, set->size, MADV_NORMAL);
+    free(handles);
+    free(workers);
+}
+
+// *******
+// writing
+// *******
+
+static void writeBytes(datasetWriter *writer, const void *bytes, size_t size)
+{
+    if (fwrite(bytes, 1, size, writer->file) != size)
+    {
+        writer->failed = true;
+    }
+    writer->offset += size;
+}
+
+static void flushChunk(datasetWriter *writer)
+{
+    if (writer->buffered == 0)
+    {
+        return;
+    }
+    if (writer->chunkCount == writer->chunkCapacity)
+    {
+        writer->chunkCapacity = writer->chunkCapacity ? writer->chunkCapacity * 2 : 64;
+        writer->chunks = (datasetChunk *)realloc(writer->chunks, writer->chunkCapacity * sizeof(datasetChunk));
+    }
+    writer->chunks[writer->chunkCount++] = (datasetChunk){writer->offset, writer->count, writer->buffered, 0};
+    writeBytes(writer, writer->buffer, writer->buffered * sizeof(trainingRecord));
+    writer->count += writer->buffered;
+    writer->buffered = 0;
+}
+
+bool createDataset(datasetWriter *writer, const char *path)
+{
+    memset(writer, 0, sizeof(*writer));
+    writer->file = fopen(path, "wb");
+    if (writer->file == NULL)
+    {
+        return false;
+    }
+    writer->buffer = (trainingRecord *)malloc(DATASET_CHUNK_RECORDS * sizeof(trainingRecord));
+    // the real header is written by finishDataset
+    datasetHeader header;
+    memset(&header, 0, sizeof(header));
+    writeBytes(writer, &header, sizeof(header));
+    return !writer->failed;
+}
+
+bool appendDataset(datasetWriter *writer, const trainingRecord *records, size_t count)
+{
+    while (count > 0)
+    {
+        size_t take = DATASET_CHUNK_RECORDS - writer->buffered;
+        take = take < count ? take : count;
+        memcpy(writer->buffer + writer->buffered, records, take * sizeof(trainingRecord));
+        writer->buffered += take;
+        records += take;
+        count -= take;
+        if (writer->buffered == DATASET_CHUNK_RECORDS)
+        {
+            flushChunk(writer);
+        }
+    }
+    return !writer->failed;
+}
+
+bool finishDataset(datasetWriter *writer)
+{
+    flushChunk(writer);
+    datasetHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DATASET_MAGIC, 8);
+    header.version = DATASET_VERSION;
+    header.recordSize = sizeof(trainingRecord);
+    header.recordCount = writer->count;
+    header.chunkCount = writer->chunkCount;
+    header.indexOffset = writer->offset;
+    writeBytes(writer, writer->chunks, writer->chunkCount * sizeof(datasetChunk));
+    if (fseek(writer->file, 0, SEEK_SET) != 0)
+    {
+        writer->failed = true;
+    }
+    writeBytes(writer, &header, sizeof(header));
+    bool ok = fclose(writer->file) == 0 && !writer->failed;
+    free(writer->chunks);
+    free(writer->buffer);
+    memset(writer, 0, sizeof(*writer));
+    return ok;
+}
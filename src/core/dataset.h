@@ -0,0 +1,79 @@
+#ifndef MEOWL_DATASET_H
+#define MEOWL_DATASET_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "packed.h"
+
+// a dataset file holds trainingRecords in chunks: a 64 byte header, the
+// chunks one after the other, then the chunk index the header points at.
+// the file is memory mapped and records are read in place, without copying
+// or parsing. everything is little endian, as in memory
+#define DATASET_MAGIC "MEOWLDS1"
+#define DATASET_VERSION 1
+#define DATASET_CHUNK_RECORDS 65536 // 2 MB
+
+typedef struct
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t recordCount;
+    uint64_t chunkCount;
+    uint64_t indexOffset; // where the chunk index starts
+    uint8_t reserved[24];
+} datasetHeader;
+
+typedef struct
+{
+    uint64_t offset; // where the chunk's records start
+    uint64_t first;  // number of records in the chunks before it
+    uint32_t count;
+    uint32_t reserved;
+} datasetChunk;
+
+typedef struct
+{
+    const uint8_t *data;
+    size_t size;
+    const datasetChunk *chunks;
+    uint64_t count;
+    uint64_t chunkCount;
+} dataset;
+
+typedef struct
+{
+    FILE *file;
+    uint64_t offset;
+    uint64_t count;
+    datasetChunk *chunks;
+    uint64_t chunkCount;
+    uint64_t chunkCapacity;
+    trainingRecord *buffer; // the chunk being filled
+    uint32_t buffered;
+    bool failed;
+} datasetWriter;
+
+// maps a dataset file, false if it cannot be read or is not a dataset
+bool openDataset(dataset *set, const char *path);
+void closeDataset(dataset *set);
+
+// record index of the whole file, without copying. index must be below set->count
+const trainingRecord *datasetRecord(const dataset *set, uint64_t index);
+// a uniformly random record of a non-empty set, random is the caller's
+// generator state (not 0)
+const trainingRecord *sampleDataset(const dataset *set, uint64_t *random);
+
+// calls visit with every chunk, the chunks shared out between threads. thread
+// is the index of the calling thread (0 to threads - 1), for per-thread sums
+typedef void (*datasetVisitor)(const trainingRecord *records, uint32_t count, int thread, void *data);
+void scanDataset(const dataset *set, int threads, datasetVisitor visit, void *data);
+
+// writes a dataset: create, append any number of records, then finish, which
+// writes the index and header and closes the file. returns false on write errors
+bool createDataset(datasetWriter *writer, const char *path);
+bool appendDataset(datasetWriter *writer, const trainingRecord *records, size_t count);
+bool finishDataset(datasetWriter *writer);
+
+#endif
@@ -0,0 +1,462 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "egtb.h"
+
+// file layout, integers little endian:
+//   0  "MEOWLTB1"
+//   8  material name, zero padded
+//   16 uint64 number of positions
+//   24 uint32 longest mate in plies
+//   28 reserved
+//   32 one value per position
+
+#define EGTB_MAX_TABLES 64
+#define EGTB_HASH_SIZE 128
+
+typedef struct
+{
+    egtbMaterial material;
+    void *base;
+    size_t mapping;
+    const uint8_t *values;
+    int maxPlies;
+} egtbTable;
+
+static egtbTable tables[EGTB_MAX_TABLES];
+static int tableCount = 0;
+static int largest = 0;
+static int tableHash[EGTB_HASH_SIZE];
+
+// a1-d1-d4 triangle, where pawnless tables keep the white king
+static const int triangle[64] = {
+    0,  1,  2,  3,  -1, -1, -1, -1,
+    -1, 4,  5,  6,  -1, -1, -1, -1,
+    -1, -1, 7,  8,  -1, -1, -1, -1,
+    -1, -1, -1, 9,  -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1,
+};
+static const int triangleSquares[10] = {0, 1, 2, 3, 9, 10, 11, 18, 19, 27};
+
+// *********
+// materials
+// *********
+
+static const char pieceChars[] = " PNBRQK";
+
+// side strings list the king first, then queens down to pawns
+static int sideOrder(int kind)
+{
+    return kind == EGTB_KING ? 0 : EGTB_KING - kind;
+}
+
+bool egtbParseMaterial(const char *name, egtbMaterial *material)
+{
+    memset(material, 0, sizeof(*material));
+    int length = (int)strlen(name);
+    if (length < 3 || length > EGTB_MAX_PIECES || name[0] != 'K')
+    {
+        return false;
+    }
+    int colour = 0;
+    for (int i = 0; i < length; i++)
+    {
+        const char *kind = strchr(pieceChars + 1, name[i]);
+        if (kind == NULL)
+        {
+            return false;
+        }
+        if (i > 0 && name[i] == 'K')
+        {
+            if (colour)
+            {
+                return false;
+            }
+            colour = EGTB_BLACK;
+        }
+        material->pieces[material->count++] = (int)(kind - pieceChars) | colour;
+        material->hasPawns |= name[i] == 'P';
+    }
+    if (!colour)
+    {
+        return false;
+    }
+    memcpy(material->name, name, length);
+
+    uint64_t kings = material->hasPawns ? 32 : 10;
+    material->size = 2 * kings;
+    for (int i = 1; i < material->count; i++)
+    {
+        material->size *= 64;
+    }
+    return true;
+}
+
+// *****
+// index
+// *****
+
+uint64_t egtbIndex(const egtbMaterial *material, bool whiteToMove, const int *squares)
+{
+    int s[EGTB_MAX_PIECES];
+    memcpy(s, squares, material->count * sizeof(int));
+
+    if ((s[0] & 7) > 3)
+    {
+        for (int i = 0; i < material->count; i++)
+        {
+            s[i] ^= 7;
+        }
+    }
+    // without pawns the board may also be flipped vertically and along a1-h8
+    if (!material->hasPawns)
+    {
+        if ((s[0] >> 3) > 3)
+        {
+            for (int i = 0; i < material->count; i++)
+            {
+                s[i] ^= 56;
+            }
+        }
+        if ((s[0] >> 3) > (s[0] & 7))
+        {
+            for (int i = 0; i < material->count; i++)
+            {
+                s[i] = (s[i] >> 3) | ((s[i] & 7) << 3);
+            }
+        }
+    }
+
+    uint64_t kings = material->hasPawns ? 32 : 10;
+    uint64_t king = material->hasPawns ? (s[0] >> 3) * 4 + (s[0] & 7) : (uint64_t)triangle[s[0]];
+    uint64_t index = (whiteToMove ? 0 : kings) + king;
+    for (int i = 1; i < material->count; i++)
+    {
+        index = index * 64 + s[i];
+    }
+    return index;
+}
+
+void egtbSquares(const egtbMaterial *material, uint64_t index, int *squares, bool *whiteToMove)
+{
+    for (int i = material->count - 1; i > 0; i--)
+    {
+        squares[i] = (int)(index % 64);
+        index /= 64;
+    }
+    uint64_t kings = material->hasPawns ? 32 : 10;
+    *whiteToMove = index < kings;
+    int king = (int)(index % kings);
+    squares[0] = material->hasPawns ? (king / 4) * 8 + king % 4 : triangleSquares[king];
+}
+
+// ***********
+// table files
+// ***********
+
+static int hashName(const char *name)
+{
+    uint64_t key = 0;
+    memcpy(&key, name, strnlen(name, 8));
+    return (int)((key * 0x9E3779B97F4A7C15ULL) >> 57) & (EGTB_HASH_SIZE - 1);
+}
+
+static egtbTable *findTable(const char *name)
+{
+    if (tableCount == 0)
+    {
+        return NULL;
+    }
+    for (int slot = hashName(name); tableHash[slot] >= 0; slot = (slot + 1) & (EGTB_HASH_SIZE - 1))
+    {
+        if (strncmp(tables[tableHash[slot]].material.name, name, 8) == 0)
+        {
+            return &tables[tableHash[slot]];
+        }
+    }
+    return NULL;
+}
+
+static uint64_t readLittleEndian(const uint8_t *bytes, int count)
+{
+    uint64_t value = 0;
+    for (int i = count - 1; i >= 0; i--)
+    {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+static bool loadTable(const char *directory, const char *file)
+{
+    char name[8] = {0};
+    size_t length = strlen(file) - strlen(EGTB_EXTENSION);
+    if (length >= sizeof(name) || tableCount == EGTB_MAX_TABLES)
+    {
+        return false;
+    }
+    memcpy(name, file, length);
+    egtbTable *table = &tables[tableCount];
+    if (!egtbParseMaterial(name, &table->material) || findTable(name) != NULL)
+    {
+        return false;
+    }
+
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s", directory, file);
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (uint64_t)info.st_size != EGTB_HEADER_SIZE + table->material.size)
+    {
+        close(fd);
+        return false;
+    }
+    void *data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+    const uint8_t *header = (const uint8_t *)data;
+    if (memcmp(header, "MEOWLTB1", 8) != 0 || strncmp((const char *)header + 8, name, 8) != 0 ||
+        readLittleEndian(header + 16, 8) != table->material.size)
+    {
+        munmap(data, info.st_size);
+        return false;
+    }
+    // probes land anywhere in the table
+    madvise(data, info.st_size, MADV_RANDOM);
+
+    table->base = data;
+    table->mapping = info.st_size;
+    table->values = header + EGTB_HEADER_SIZE;
+    table->maxPlies = (int)readLittleEndian(header + 24, 4);
+
+    int slot = hashName(name);
+    while (tableHash[slot] >= 0)
+    {
+        slot = (slot + 1) & (EGTB_HASH_SIZE - 1);
+    }
+    tableHash[slot] = tableCount++;
+    if (table->material.count > largest)
+    {
+        largest = table->material.count;
+    }
+    return true;
+}
+
+void egtbFree(void)
+{
+    for (int i = 0; i < tableCount; i++)
+    {
+        munmap(tables[i].base, tables[i].mapping);
+    }
+    tableCount = 0;
+    largest = 0;
+    for (int i = 0; i < EGTB_HASH_SIZE; i++)
+    {
+        tableHash[i] = -1;
+    }
+}
+
+int egtbInit(const char *directory)
+{
+    egtbFree();
+    DIR *dir = opendir(directory);
+    if (dir == NULL)
+    {
+        return 0;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        size_t length = strlen(entry->d_name);
+        size_t extension = strlen(EGTB_EXTENSION);
+        if (length > extension && strcmp(entry->d_name + length - extension, EGTB_EXTENSION) == 0)
+        {
+            loadTable(directory, entry->d_name);
+        }
+    }
+    closedir(dir);
+    return tableCount;
+}
+
+int egtbLargest(void)
+{
+    return largest;
+}
+
+int egtbMaxPlies(const char *name)
+{
+    egtbTable *table = findTable(name);
+    return table ? table->maxPlies : -1;
+}
+
+// *******
+// probing
+// *******
+
+// writes one side's pieces in name order into name and the matching squares
+static int sideName(const int *pieces, const int *squares, int count, int colour, char *name, int *sideSquares)
+{
+    int order[EGTB_MAX_PIECES];
+    int length = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if ((pieces[i] & EGTB_BLACK) == colour)
+        {
+            order[length++] = i;
+        }
+    }
+    // insertion sort by kind, then square so duplicates always land the same way
+    for (int i = 1; i < length; i++)
+    {
+        int current = order[i];
+        int j = i - 1;
+        while (j >= 0 && (sideOrder(pieces[order[j]] & 7) > sideOrder(pieces[current] & 7) ||
+                          (pieces[order[j]] == pieces[current] && squares[order[j]] > squares[current])))
+        {
+            order[j + 1] = order[j];
+            j--;
+        }
+        order[j + 1] = current;
+    }
+    for (int i = 0; i < length; i++)
+    {
+        name[i] = pieceChars[pieces[order[i]] & 7];
+        sideSquares[i] = squares[order[i]];
+    }
+    return length;
+}
+
+int egtbProbePieces(const int *pieces, const int *squares, int count, bool whiteToMove, bool *found)
+{
+    *found = false;
+    if (count == 2)
+    {
+        *found = true;
+        return EGTB_DRAW;
+    }
+    if (count > EGTB_MAX_PIECES || tableCount == 0)
+    {
+        return EGTB_DRAW;
+    }
+
+    char white[EGTB_MAX_PIECES + 1] = {0};
+    char black[EGTB_MAX_PIECES + 1] = {0};
+    int whiteSquares[EGTB_MAX_PIECES];
+    int blackSquares[EGTB_MAX_PIECES];
+    int whiteCount = sideName(pieces, squares, count, 0, white, whiteSquares);
+    int blackCount = sideName(pieces, squares, count, EGTB_BLACK, black, blackSquares);
+
+    char name[8] = {0};
+    int ordered[EGTB_MAX_PIECES];
+    snprintf(name, sizeof(name), "%s%s", white, black);
+    egtbTable *table = findTable(name);
+    if (table != NULL)
+    {
+        memcpy(ordered, whiteSquares, whiteCount * sizeof(int));
+        memcpy(ordered + whiteCount, blackSquares, blackCount * sizeof(int));
+    }
+    else
+    {
+        // black holds the stored side's material: swap colours and flip the board
+        snprintf(name, sizeof(name), "%s%s", black, white);
+        table = findTable(name);
+        if (table == NULL)
+        {
+            return EGTB_DRAW;
+        }
+        for (int i = 0; i < blackCount; i++)
+        {
+            ordered[i] = blackSquares[i] ^ 56;
+        }
+        for (int i = 0; i < whiteCount; i++)
+        {
+            ordered[blackCount + i] = whiteSquares[i] ^ 56;
+        }
+        whiteToMove = !whiteToMove;
+    }
+    *found = true;
+    return table->values[egtbIndex(&table->material, whiteToMove, ordered)];
+}
+
+// the better of two values for the side to move: the fastest win, a draw,
+// or else the slowest loss
+static int betterValue(int a, int b)
+{
+    int rankA = EGTB_IS_WIN(a) ? 1000 - a : EGTB_IS_LOSS(a) ? -1000 + a : 0;
+    int rankB = EGTB_IS_WIN(b) ? 1000 - b : EGTB_IS_LOSS(b) ? -1000 + b : 0;
+    return rankA >= rankB ? a : b;
+}
+
+int egtbProbe(game position, bool *found)
+{
+    *found = false;
+    bitboard occupied = getPieces(position.board);
+    if ((position.metadata & CASTLE_ALL) || numSignificantBits(occupied) > largest)
+    {
+        return EGTB_DRAW;
+    }
+
+    int pieces[EGTB_MAX_PIECES];
+    int squares[EGTB_MAX_PIECES];
+    int count = 0;
+    board b = position.board;
+    while (occupied)
+    {
+        int s = trailingZeros(occupied);
+        bitboard mask = 1ULL << s;
+        int kind = b.pawn & mask     ? EGTB_PAWN
+                   : b.knight & mask ? EGTB_KNIGHT
+                   : b.bishop & mask ? EGTB_BISHOP
+                   : b.rook & mask   ? EGTB_ROOK
+                   : b.queen & mask  ? EGTB_QUEEN
+                                     : EGTB_KING;
+        pieces[count] = kind | (b.white & mask ? 0 : EGTB_BLACK);
+        squares[count++] = s;
+        occupied &= occupied - 1;
+    }
+    bool whiteToMove = position.metadata & WHITE_TO_MOVE;
+    int value = egtbProbePieces(pieces, squares, count, whiteToMove, found);
+
+    // tables know nothing of en passant, the captures are looked up separately
+    uint16_t capturable = whiteToMove ? position.en_passants >> 8 : position.en_passants & 0xFF;
+    if (*found && capturable && (b.pawn & (whiteToMove ? b.white : ~b.white)))
+    {
+        move *moves = getValidMoves(position);
+        for (int i = 0; moves[i].original != -1; i++)
+        {
+            bool isEnPassant = (b.pawn >> moves[i].original & 1) && moves[i].original % 8 != moves[i].next % 8 &&
+                               !(getPieces(b) >> moves[i].next & 1);
+            if (!isEnPassant)
+            {
+                continue;
+            }
+            game child = position;
+            executeMove(&child, moves[i]);
+            bool childFound;
+            int childValue = egtbProbe(child, &childFound);
+            if (!childFound)
+            {
+                *found = false;
+                break;
+            }
+            value = betterValue(value, childValue == EGTB_DRAW ? EGTB_DRAW : childValue + 1);
+        }
+        free(moves);
+    }
+    return value;
+}
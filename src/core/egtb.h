@@ -0,0 +1,65 @@
+#ifndef MEOWL_EGTB_H
+#define MEOWL_EGTB_H
+
+#include "bitboards.h"
+
+// Meowl's own endgame tables of up to 4 pieces with exact distance to mate,
+// built by the tbgen tool. a table is one byte per position behind a 32 byte
+// header, indexed directly from the piece squares, so a probe is one lookup
+#define EGTB_MAX_PIECES 4
+#define EGTB_HEADER_SIZE 32
+#define EGTB_EXTENSION ".mtb"
+
+// table values: 0 is a draw, otherwise 1 + plies to mate. an even number of
+// plies means the side to move is the one getting mated
+#define EGTB_DRAW 0
+#define EGTB_PLIES(value) ((value) - 1)
+#define EGTB_IS_WIN(value) ((value) > 0 && EGTB_PLIES(value) % 2 == 1)
+#define EGTB_IS_LOSS(value) ((value) > 0 && EGTB_PLIES(value) % 2 == 0)
+
+// piece kinds, or'ed with EGTB_BLACK for black pieces
+#define EGTB_PAWN 1
+#define EGTB_KNIGHT 2
+#define EGTB_BISHOP 3
+#define EGTB_ROOK 4
+#define EGTB_QUEEN 5
+#define EGTB_KING 6
+#define EGTB_BLACK 8
+
+typedef struct
+{
+    char name[8]; // white's pieces then black's, each side starting with its king: "KRKP"
+    int count;
+    int pieces[EGTB_MAX_PIECES]; // in the order of the name, which is the index order
+    bool hasPawns;
+    uint64_t size; // positions in the table
+} egtbMaterial;
+
+bool egtbParseMaterial(const char *name, egtbMaterial *material);
+
+// table index of the pieces on squares (in material order). positions are
+// mirrored so that the white king sits in a1-d1-d4 (a1-d8 with pawns)
+uint64_t egtbIndex(const egtbMaterial *material, bool whiteToMove, const int *squares);
+
+// the position stored at an index, for generating tables
+void egtbSquares(const egtbMaterial *material, uint64_t index, int *squares, bool *whiteToMove);
+
+// maps every .mtb file in directory, returns the number of tables
+int egtbInit(const char *directory);
+void egtbFree(void);
+
+// most pieces covered by the loaded tables, 0 if there are none
+int egtbLargest(void);
+
+// longest mate stored in the named table, -1 if it is not loaded
+int egtbMaxPlies(const char *name);
+
+// value of any placement of pieces without castling or en passant rights,
+// whichever side holds the stronger material
+int egtbProbePieces(const int *pieces, const int *squares, int count, bool whiteToMove, bool *found);
+
+// value of a game position, en passant captures included. positions with
+// castling rights are never found
+int egtbProbe(game position, bool *found);
+
+#endif
@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "eval.h"
+#include "pawns.h"
+#include "material.h"
+
+// ************
+// piece tables
+// ************
+
+// laid out as seen from white's side, rank 8 first (see weights.h)
+static const int pawnTable[64] = PAWN_TABLE;
+static const int knightTable[64] = KNIGHT_TABLE;
+static const int bishopTable[64] = BISHOP_TABLE;
+static const int rookTable[64] = ROOK_TABLE;
+static const int queenTable[64] = QUEEN_TABLE;
+static const int kingTable[64] = KING_TABLE;
+
+// ******************
+// evaluation helpers
+// ******************
+
+// sums value + table bonus for one piece type, white minus black
+static int scorePieces(bitboard pieces, bitboard white, int value, const int table[64])
+{
+    int score = 0;
+    while (pieces > 0)
+    {
+        int sq = trailingZeros(pieces);
+        int file = sq % 8;
+        int rank = sq / 8;
+        if (white >> sq & 1)
+        {
+            score += value + table[(7 - rank) * 8 + file];
+        }
+        else
+        {
+            score -= value + table[rank * 8 + file];
+        }
+        pieces &= pieces - 1;
+    }
+    return score;
+}
+
+int mobilityFeature(board board)
+{
+    bitboard black = getPieces(board) & ~board.white;
+    return numSignificantBits(getAttackedSquares(board, true) & ~board.white) -
+           numSignificantBits(getAttackedSquares(board, false) & ~black);
+}
+
+int evaluate(game game)
+{
+    board b = game.board;
+    const materialEntry *material = probeMaterial(b);
+    if (material->evaluate != NULL)
+    {
+        int score = material->evaluate(game, material);
+        return (game.metadata & WHITE_TO_MOVE) ? score : -score;
+    }
+
+    int score = material->imbalance;
+    score += scorePieces(b.pawn, b.white, PAWN_VALUE, pawnTable);
+    score += scorePieces(b.knight, b.white, KNIGHT_VALUE, knightTable);
+    score += scorePieces(b.bishop, b.white, BISHOP_VALUE, bishopTable);
+    score += scorePieces(b.rook, b.white, ROOK_VALUE, rookTable);
+    score += scorePieces(b.queen, b.white, QUEEN_VALUE, queenTable);
+    score += scorePieces(b.king, b.white, 0, kingTable);
+    score += probePawns(b)->score;
+    score += mobilityFeature(b) * MOBILITY;
+    if (material->scale != NULL)
+    {
+        score = score * material->scale(game, material) / SCALE_NORMAL;
+    }
+
+    return (game.metadata & WHITE_TO_MOVE) ? score : -score;
+}
+
+int pieceValue(board board, square sq)
+{
+    bitboard bit = 1ULL << sq;
+    if (board.pawn & bit)
+    {
+        return PAWN_VALUE;
+    }
+    else if (board.knight & bit)
+    {
+        return KNIGHT_VALUE;
+    }
+    else if (board.bishop & bit)
+    {
+        return BISHOP_VALUE;
+    }
+    else if (board.rook & bit)
+    {
+        return ROOK_VALUE;
+    }
+    else if (board.queen & bit)
+    {
+        return QUEEN_VALUE;
+    }
+    return 0;
+}
@@ -0,0 +1,17 @@
+#ifndef MEOWL_EVAL_H
+#define MEOWL_EVAL_H
+
+#include "bitboards.h"
+#include "weights.h"
+
+// static evaluation in centipawns from the side to move's point of view
+int evaluate(game game);
+
+// mobility: squares a side attacks that are not taken by its own pieces,
+// white's count minus black's
+int mobilityFeature(board board);
+
+// value of whatever stands on a square, 0 if it is empty (kings count as 0 too)
+int pieceValue(board board, square sq);
+
+#endif
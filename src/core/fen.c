@@ -0,0 +1,329 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "fen.h"
+
+// ****************
+// reading FEN text
+// ****************
+
+static const char *skipSpaces(const char *c)
+{
+    while (*c == ' ' || *c == '\t')
+    {
+        c++;
+    }
+    return c;
+}
+
+// at most this many digits, so the number always fits in an int
+#define NUMBER_DIGITS 9
+
+// NULL if the number is longer than NUMBER_DIGITS
+static const char *parseNumber(const char *c, int *value)
+{
+    int number = 0;
+    for (int digits = 0; *c >= '0' && *c <= '9'; digits++)
+    {
+        if (digits == NUMBER_DIGITS)
+        {
+            return NULL;
+        }
+        number = number * 10 + (*c - '0');
+        c++;
+    }
+    *value = number;
+    return c;
+}
+
+const char *parseFen(game *game, const char *fen)
+{
+    board board = {0};
+    uint8_t metadata = 0;
+    uint16_t en_passants = 0;
+    int halfmove = 0;
+    int fullmove = 1;
+
+    // piece placement, rank 8 first
+    const char *c = skipSpaces(fen);
+    int rank = 7;
+    int file = 0;
+    for (; *c != 0 && *c != ' '; c++)
+    {
+        if (*c == '/')
+        {
+            if (file != 8 || rank == 0)
+            {
+                return NULL;
+            }
+            rank--;
+            file = 0;
+            continue;
+        }
+        if (*c >= '1' && *c <= '8')
+        {
+            file += *c - '0';
+            if (file > 8)
+            {
+                return NULL;
+            }
+            continue;
+        }
+        if (file >= 8)
+        {
+            return NULL;
+        }
+
+        bitboard bit = SQUARE(file, rank);
+        switch (*c | 32)
+        {
+        case 'p':
+            board.pawn |= bit;
+            break;
+        case 'n':
+            board.knight |= bit;
+            break;
+        case 'b':
+            board.bishop |= bit;
+            break;
+        case 'r':
+            board.rook |= bit;
+            break;
+        case 'q':
+            board.queen |= bit;
+            break;
+        case 'k':
+            board.king |= bit;
+            break;
+        default:
+            return NULL;
+        }
+        if (*c < 'a')
+        {
+            board.white |= bit;
+        }
+        file++;
+    }
+    if (rank != 0 || file != 8)
+    {
+        return NULL;
+    }
+
+    // side to move
+    c = skipSpaces(c);
+    if (*c == 'w')
+    {
+        metadata |= WHITE_TO_MOVE;
+    }
+    else if (*c != 'b')
+    {
+        return NULL;
+    }
+    c++;
+
+    // castling rights
+    c = skipSpaces(c);
+    if (*c == '-')
+    {
+        c++;
+    }
+    else
+    {
+        for (; *c != 0 && *c != ' '; c++)
+        {
+            switch (*c)
+            {
+            case 'K':
+                metadata |= CASTLE_WHITE_KING;
+                break;
+            case 'Q':
+                metadata |= CASTLE_WHITE_QUEEN;
+                break;
+            case 'k':
+                metadata |= CASTLE_BLACK_KING;
+                break;
+            case 'q':
+                metadata |= CASTLE_BLACK_QUEEN;
+                break;
+            default:
+                return NULL;
+            }
+        }
+    }
+
+    // en passant square, the one skipped by the pawn that just moved two
+    // squares, so on rank 6 with white to move and on rank 3 with black
+    c = skipSpaces(c);
+    if (*c == '-')
+    {
+        c++;
+    }
+    else if (c[0] >= 'a' && c[0] <= 'h' && c[1] == (metadata & WHITE_TO_MOVE ? '6' : '3'))
+    {
+        en_passants = 1 << ((c[0] - 'a') + (c[1] == '3' ? 0 : 8));
+        c += 2;
+    }
+    else
+    {
+        return NULL;
+    }
+
+    // clocks are optional
+    const char *clocks = skipSpaces(c);
+    if (*clocks >= '0' && *clocks <= '9')
+    {
+        c = parseNumber(clocks, &halfmove);
+        clocks = c != NULL ? skipSpaces(c) : NULL;
+        if (clocks != NULL && *clocks >= '0' && *clocks <= '9')
+        {
+            c = parseNumber(clocks, &fullmove);
+        }
+        if (c == NULL)
+        {
+            return NULL;
+        }
+    }
+
+    game->board = board;
+    game->metadata = metadata;
+    game->en_passants = en_passants;
+    game->halfmove_clock = halfmove > 255 ? 255 : halfmove;
+    game->fullmove_number = fullmove > 0xFFFF ? 0xFFFF : fullmove > 0 ? fullmove : 1;
+    game->moves = (list_t){0, 0, 0};
+    return c;
+}
+
+// ****************
+// writing FEN text
+// ****************
+
+static char pieceChar(board board, bitboard bit)
+{
+    char piece = 0;
+    if (board.pawn & bit)
+    {
+        piece = 'p';
+    }
+    else if (board.knight & bit)
+    {
+        piece = 'n';
+    }
+    else if (board.bishop & bit)
+    {
+        piece = 'b';
+    }
+    else if (board.rook & bit)
+    {
+        piece = 'r';
+    }
+    else if (board.queen & bit)
+    {
+        piece = 'q';
+    }
+    else if (board.king & bit)
+    {
+        piece = 'k';
+    }
+    if (piece && (board.white & bit))
+    {
+        piece -= 32;
+    }
+    return piece;
+}
+
+static char *writeNumber(char *out, int value)
+{
+    char digits[8];
+    int count = 0;
+    do
+    {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while (value > 0);
+    while (count > 0)
+    {
+        *out++ = digits[--count];
+    }
+    return out;
+}
+
+int writeFen(game game, char *out)
+{
+    char *c = out;
+    bitboard occupied = getPieces(game.board);
+
+    for (int rank = 7; rank >= 0; rank--)
+    {
+        int empty = 0;
+        for (int file = 0; file < 8; file++)
+        {
+            bitboard bit = SQUARE(file, rank);
+            if (!(occupied & bit))
+            {
+                empty++;
+                continue;
+            }
+            if (empty > 0)
+            {
+                *c++ = '0' + empty;
+                empty = 0;
+            }
+            *c++ = pieceChar(game.board, bit);
+        }
+        if (empty > 0)
+        {
+            *c++ = '0' + empty;
+        }
+        if (rank > 0)
+        {
+            *c++ = '/';
+        }
+    }
+
+    *c++ = ' ';
+    *c++ = (game.metadata & WHITE_TO_MOVE) ? 'w' : 'b';
+
+    *c++ = ' ';
+    if (!(game.metadata & CASTLE_ALL))
+    {
+        *c++ = '-';
+    }
+    if (game.metadata & CASTLE_WHITE_KING)
+    {
+        *c++ = 'K';
+    }
+    if (game.metadata & CASTLE_WHITE_QUEEN)
+    {
+        *c++ = 'Q';
+    }
+    if (game.metadata & CASTLE_BLACK_KING)
+    {
+        *c++ = 'k';
+    }
+    if (game.metadata & CASTLE_BLACK_QUEEN)
+    {
+        *c++ = 'q';
+    }
+
+    *c++ = ' ';
+    if (game.en_passants & 0xFF)
+    {
+        *c++ = 'a' + trailingZeros(game.en_passants & 0xFF);
+        *c++ = '3';
+    }
+    else if (game.en_passants >> 8)
+    {
+        *c++ = 'a' + trailingZeros(game.en_passants >> 8);
+        *c++ = '6';
+    }
+    else
+    {
+        *c++ = '-';
+    }
+
+    *c++ = ' ';
+    c = writeNumber(c, game.halfmove_clock);
+    *c++ = ' ';
+    c = writeNumber(c, game.fullmove_number);
+    *c = 0;
+    return c - out;
+}
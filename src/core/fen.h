@@ -0,0 +1,19 @@
+#ifndef MEOWL_FEN_H
+#define MEOWL_FEN_H
+
+#include "bitboards.h"
+
+// longest possible FEN plus terminator
+#define FEN_MAX 92
+
+#define STARTING_FEN "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
+
+// parses a FEN string into game without allocating. the halfmove and fullmove
+// fields are optional (EPD lines leave them out). returns a pointer just past
+// the parsed text, or NULL if the FEN is malformed, in which case game is untouched
+const char *parseFen(game *game, const char *fen);
+
+// writes game as a FEN string into out (at least FEN_MAX bytes), returns its length
+int writeFen(game game, char *out);
+
+#endif
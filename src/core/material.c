@@ -0,0 +1,228 @@
+#include <stdlib.h>
+#include "material.h"
+#include "weights.h"
+
+// scores of won endgames, above anything the normal evaluation gives but well
+// below mate and tablebase scores
+#define KNOWN_WIN 1000
+
+#define DARK_SQUARES 0xAA55AA55AA55AA55ULL
+
+// indexes of materialCounts
+#define COUNT_PAWN 0
+#define COUNT_KNIGHT 1
+#define COUNT_BISHOP 2
+#define COUNT_ROOK 3
+#define COUNT_QUEEN 4
+
+typedef struct
+{
+    int counts[2][5]; // [white, black][COUNT_...]
+} materialCounts;
+
+static materialCounts countMaterial(board board)
+{
+    const bitboard kinds[5] = {board.pawn, board.knight, board.bishop, board.rook, board.queen};
+    materialCounts material;
+    for (int kind = 0; kind < 5; kind++)
+    {
+        material.counts[0][kind] = numSignificantBits(kinds[kind] & board.white);
+        material.counts[1][kind] = numSignificantBits(kinds[kind] & ~board.white);
+    }
+    return material;
+}
+
+static uint64_t materialKey(const materialCounts *material)
+{
+    uint64_t key = 0;
+    for (int side = 0; side < 2; side++)
+    {
+        for (int kind = 0; kind < 5; kind++)
+        {
+            key |= (uint64_t)material->counts[side][kind] << (4 * (side * 5 + kind));
+        }
+    }
+    return key;
+}
+
+// true if side has exactly the given pieces besides its king
+static bool hasOnly(const materialCounts *material, int side, int pawns, int knights, int bishops, int rooks,
+                    int queens)
+{
+    const int *counts = material->counts[side];
+    return counts[COUNT_PAWN] == pawns && counts[COUNT_KNIGHT] == knights && counts[COUNT_BISHOP] == bishops &&
+           counts[COUNT_ROOK] == rooks && counts[COUNT_QUEEN] == queens;
+}
+
+// *********
+// imbalance
+// *********
+
+static void featuresOf(const materialCounts *material, int features[MATERIAL_FEATURES])
+{
+    const int *white = material->counts[0];
+    const int *black = material->counts[1];
+    features[MATERIAL_BISHOP_PAIR] = (white[COUNT_BISHOP] >= 2) - (black[COUNT_BISHOP] >= 2);
+    features[MATERIAL_KNIGHT_PAWNS] =
+        white[COUNT_KNIGHT] * (white[COUNT_PAWN] - 5) - black[COUNT_KNIGHT] * (black[COUNT_PAWN] - 5);
+    features[MATERIAL_ROOK_PAWNS] =
+        white[COUNT_ROOK] * (white[COUNT_PAWN] - 5) - black[COUNT_ROOK] * (black[COUNT_PAWN] - 5);
+}
+
+void materialFeatures(board board, int features[MATERIAL_FEATURES])
+{
+    materialCounts material = countMaterial(board);
+    featuresOf(&material, features);
+}
+
+// ********
+// endgames
+// ********
+
+static int distance(int a, int b)
+{
+    int files = abs(a % 8 - b % 8);
+    int ranks = abs(a / 8 - b / 8);
+    return files > ranks ? files : ranks;
+}
+
+// king and bishop and knight against a lone king: drive the king into a
+// corner of the bishop's colour, with the other king close
+static int evaluateKBNK(game position, const materialEntry *entry)
+{
+    board b = position.board;
+    bitboard strong = entry->strongWhite ? b.white : ~b.white;
+    int strongKing = trailingZeros(b.king & strong);
+    int weakKing = trailingZeros(b.king & ~strong);
+    bool dark = (b.bishop & DARK_SQUARES) != 0;
+    // a1 and h8 are dark, a8 and h1 light
+    int first = dark ? 0 : 56;
+    int second = dark ? 63 : 7;
+    int corner = distance(weakKing, first) < distance(weakKing, second) ? distance(weakKing, first)
+                                                                          : distance(weakKing, second);
+    int score = KNOWN_WIN + 20 * (7 - corner) + 10 * (7 - distance(strongKing, weakKing));
+    return entry->strongWhite ? score : -score;
+}
+
+// king and rook against king and pawn, from the rook's side: won if its king
+// is in front of the pawn or the other king is too far away to help it
+static int evaluateKRKP(game position, const materialEntry *entry)
+{
+    board b = position.board;
+    bitboard strong = entry->strongWhite ? b.white : ~b.white;
+    // mirrored so the strong side plays up the board and the pawn moves down
+    int flip = entry->strongWhite ? 0 : 56;
+    int strongKing = trailingZeros(b.king & strong) ^ flip;
+    int weakKing = trailingZeros(b.king & ~strong) ^ flip;
+    int rook = trailingZeros(b.rook) ^ flip;
+    int pawn = trailingZeros(b.pawn) ^ flip;
+    int queening = pawn % 8;
+    bool strongToMove = ((position.metadata & WHITE_TO_MOVE) != 0) == entry->strongWhite;
+
+    int score;
+    if (strongKing % 8 == pawn % 8 && strongKing < pawn)
+    {
+        score = ROOK_VALUE - distance(strongKing, pawn);
+    }
+    else if (distance(weakKing, pawn) >= 3 + !strongToMove && distance(weakKing, rook) >= 3)
+    {
+        score = ROOK_VALUE - distance(strongKing, pawn);
+    }
+    else if (weakKing / 8 <= 2 && distance(weakKing, pawn) == 1 && strongKing / 8 >= 3 &&
+             distance(strongKing, pawn) > 2 + strongToMove)
+    {
+        score = 40 - 4 * distance(strongKing, pawn);
+    }
+    else
+    {
+        score = 100 - 8 * (distance(strongKing, pawn - 8) - distance(weakKing, pawn - 8) - distance(pawn, queening));
+    }
+    return entry->strongWhite ? score : -score;
+}
+
+// one bishop each on opposite colours and nothing else but pawns: even a
+// couple of extra pawns rarely win
+static int scaleOppositeBishops(game position, const materialEntry *entry)
+{
+    (void)entry;
+    board b = position.board;
+    bitboard white = b.bishop & b.white;
+    bitboard black = b.bishop & ~b.white;
+    if (((white & DARK_SQUARES) != 0) == ((black & DARK_SQUARES) != 0))
+    {
+        return SCALE_NORMAL;
+    }
+    return SCALE_NORMAL / 4;
+}
+
+static void findEndgame(materialEntry *entry, const materialCounts *material)
+{
+    for (int side = 0; side < 2; side++)
+    {
+        if (hasOnly(material, side, 0, 1, 1, 0, 0) && hasOnly(material, !side, 0, 0, 0, 0, 0))
+        {
+            entry->evaluate = evaluateKBNK;
+            entry->strongWhite = side == 0;
+        }
+        else if (hasOnly(material, side, 0, 0, 0, 1, 0) && hasOnly(material, !side, 1, 0, 0, 0, 0))
+        {
+            entry->evaluate = evaluateKRKP;
+            entry->strongWhite = side == 0;
+        }
+    }
+    // one bishop each and no other pieces, pawns of any number
+    bool bishops = true;
+    for (int side = 0; side < 2; side++)
+    {
+        const int *counts = material->counts[side];
+        bishops = bishops && hasOnly(material, side, counts[COUNT_PAWN], 0, 1, 0, 0);
+    }
+    if (bishops)
+    {
+        entry->scale = scaleOppositeBishops;
+    }
+}
+
+// *******************
+// material hash table
+// *******************
+
+// every thread searches with its own table, zeroed at start, which is also
+// the right entry for key 0 (bare kings)
+static _Thread_local materialEntry materialTable[MATERIAL_HASH_ENTRIES];
+
+const materialEntry *probeMaterial(board board)
+{
+    materialCounts material = countMaterial(board);
+    uint64_t key = materialKey(&material);
+    materialEntry *entry = &materialTable[(key * 0x9E3779B97F4A7C15ULL >> 54) & (MATERIAL_HASH_ENTRIES - 1)];
+    if (entry->key == key)
+    {
+        return entry;
+    }
+
+    int features[MATERIAL_FEATURES];
+    featuresOf(&material, features);
+    entry->key = key;
+    entry->imbalance = (int16_t)(features[MATERIAL_BISHOP_PAIR] * BISHOP_PAIR +
+                                 features[MATERIAL_KNIGHT_PAWNS] * KNIGHT_PAWNS +
+                                 features[MATERIAL_ROOK_PAWNS] * ROOK_PAWNS);
+    int phase = 0;
+    for (int side = 0; side < 2; side++)
+    {
+        phase += material.counts[side][COUNT_KNIGHT] + material.counts[side][COUNT_BISHOP] +
+                 2 * material.counts[side][COUNT_ROOK] + 4 * material.counts[side][COUNT_QUEEN];
+    }
+    entry->phase = (uint8_t)(phase < PHASE_MAX ? phase : PHASE_MAX);
+    entry->evaluate = NULL;
+    entry->scale = NULL;
+    entry->strongWhite = false;
+    findEndgame(entry, &material);
+    return entry;
+}
+
+bool usesEndgameRules(game position)
+{
+    const materialEntry *entry = probeMaterial(position.board);
+    return entry->evaluate != NULL || (entry->scale != NULL && entry->scale(position, entry) != SCALE_NORMAL);
+}
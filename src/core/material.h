@@ -0,0 +1,55 @@
+#ifndef MEOWL_MATERIAL_H
+#define MEOWL_MATERIAL_H
+
+#include <stdint.h>
+#include "bitboards.h"
+
+// indexes of the material imbalance features, each one white's count minus
+// black's: a bishop pair, and every knight or rook times the own pawns above 5
+#define MATERIAL_BISHOP_PAIR 0
+#define MATERIAL_KNIGHT_PAWNS 1
+#define MATERIAL_ROOK_PAWNS 2
+#define MATERIAL_FEATURES 3
+
+void materialFeatures(board board, int features[MATERIAL_FEATURES]);
+
+// game phase from the pieces left: knights and bishops 1, rooks 2, queens 4
+#define PHASE_MAX 24
+
+// scale factors are out of SCALE_NORMAL
+#define SCALE_NORMAL 64
+
+// *******************
+// material hash table
+// *******************
+
+// entries per thread, 32 bytes each: 32 KB. few material combinations come up
+// in one search, so this is plenty
+#define MATERIAL_HASH_ENTRIES 1024
+
+typedef struct materialEntry materialEntry;
+
+// replaces the evaluation of a known endgame, score from white's side
+typedef int (*endgameEvaluator)(game position, const materialEntry *entry);
+// scales the evaluation of a drawish endgame, SCALE_NORMAL to leave it as it is
+typedef int (*endgameScale)(game position, const materialEntry *entry);
+
+struct materialEntry
+{
+    uint64_t key;              // piece counts, 4 bits per kind and colour
+    endgameEvaluator evaluate; // NULL for the normal evaluation
+    endgameScale scale;        // NULL if it is never scaled
+    int16_t imbalance;         // from white's side
+    uint8_t phase;             // 0 to PHASE_MAX, capped
+    bool strongWhite;          // side with the material to win, for evaluate
+};
+
+// the material of board, from the calling thread's table. worked out and
+// stored first if it is not there
+const materialEntry *probeMaterial(board board);
+
+// true if an endgame evaluator or scale changes the score of position, which
+// then is not the sum of the evaluation weights
+bool usesEndgameRules(game position);
+
+#endif
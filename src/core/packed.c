@@ -0,0 +1,162 @@
+#include <string.h>
+#include "packed.h"
+
+// the record sizes are part of the file formats
+_Static_assert(sizeof(packedPosition) == 28, "packedPosition must stay 28 bytes");
+_Static_assert(sizeof(trainingRecord) == 32, "trainingRecord must stay 32 bytes");
+
+#define FILE_A 0x0101010101010101ULL
+#define FILE_H 0x8080808080808080ULL
+
+// the piece nibbles are three bit planes plus colour: bit 0 is set for pawns,
+// bishops and queens, bit 1 for knights, bishops and kings, bit 2 for rooks,
+// queens and kings. both directions then work on whole bitboards without
+// branching on the piece on each square
+
+game canonicalPosition(game position)
+{
+    board b = position.board;
+    game canonical = position;
+    canonical.moves = (list_t){0, 0, 0};
+    canonical.metadata &= WHITE_TO_MOVE | CASTLE_ALL;
+
+    bitboard whiteKing = b.king & b.white;
+    bitboard blackKing = b.king & ~b.white;
+    bitboard whiteRooks = b.rook & b.white;
+    bitboard blackRooks = b.rook & ~b.white;
+    if (!(whiteKing & SQUARE(4, 0)) || !(whiteRooks & SQUARE(7, 0)))
+    {
+        canonical.metadata &= ~CASTLE_WHITE_KING;
+    }
+    if (!(whiteKing & SQUARE(4, 0)) || !(whiteRooks & SQUARE(0, 0)))
+    {
+        canonical.metadata &= ~CASTLE_WHITE_QUEEN;
+    }
+    if (!(blackKing & SQUARE(4, 7)) || !(blackRooks & SQUARE(7, 7)))
+    {
+        canonical.metadata &= ~CASTLE_BLACK_KING;
+    }
+    if (!(blackKing & SQUARE(4, 7)) || !(blackRooks & SQUARE(0, 7)))
+    {
+        canonical.metadata &= ~CASTLE_BLACK_QUEEN;
+    }
+
+    // keep an en passant file only when the pawn that moved is there and a
+    // pawn of the side to move stands next to it
+    canonical.en_passants = 0;
+    bool whiteToMove = position.metadata & WHITE_TO_MOVE;
+    uint8_t files = whiteToMove ? position.en_passants >> 8 : position.en_passants & 0xFF;
+    if (files)
+    {
+        int file = trailingZeros(files);
+        bitboard moved = whiteToMove ? SQUARE(file, 4) : SQUARE(file, 3);
+        bitboard enemyPawns = b.pawn & (whiteToMove ? ~b.white : b.white);
+        bitboard capturers = b.pawn & (whiteToMove ? b.white : ~b.white);
+        bitboard beside = (moved << 1 & ~FILE_A) | (moved >> 1 & ~FILE_H);
+        if ((enemyPawns & moved) && (capturers & beside))
+        {
+            canonical.en_passants = 1 << (file + (whiteToMove ? 8 : 0));
+        }
+    }
+    if (canonical.fullmove_number > 255)
+    {
+        canonical.fullmove_number = 255;
+    }
+    return canonical;
+}
+
+static void packCanonical(const game *position, packedPosition *out)
+{
+    board b = position->board;
+    bitboard occupied = getPieces(b);
+    bitboard planes[4] = {b.pawn | b.bishop | b.queen, b.knight | b.bishop | b.king, b.rook | b.queen | b.king,
+                          occupied & ~b.white};
+    memset(out, 0, sizeof(*out));
+    out->occupancy[0] = (uint32_t)occupied;
+    out->occupancy[1] = (uint32_t)(occupied >> 32);
+
+    // more than 32 pieces cannot come from a legal game, the rest are dropped
+    int index = 0;
+    for (bitboard bits = occupied; bits && index < 32; bits &= bits - 1, index++)
+    {
+        bitboard bit = bits & -bits;
+        int nibble = (!!(planes[0] & bit)) | (!!(planes[1] & bit) << 1) | (!!(planes[2] & bit) << 2) |
+                     (!!(planes[3] & bit) << 3);
+        out->pieces[index / 2] |= nibble << (index % 2 * 4);
+    }
+
+    out->state = position->metadata;
+    if (position->en_passants & 0xFF)
+    {
+        out->enPassant = 16 + trailingZeros(position->en_passants & 0xFF);
+    }
+    else if (position->en_passants >> 8)
+    {
+        out->enPassant = 40 + trailingZeros(position->en_passants >> 8);
+    }
+    out->halfmoveClock = position->halfmove_clock;
+    out->fullmoveNumber = position->fullmove_number;
+}
+
+void packPosition(game position, packedPosition *out)
+{
+    game canonical = canonicalPosition(position);
+    packCanonical(&canonical, out);
+}
+
+void unpackPosition(const packedPosition *packed, game *out)
+{
+    memset(out, 0, sizeof(*out));
+    bitboard occupied = (bitboard)packed->occupancy[1] << 32 | packed->occupancy[0];
+    bitboard planes[4] = {0, 0, 0, 0};
+    int index = 0;
+    for (bitboard bits = occupied; bits && index < 32; bits &= bits - 1, index++)
+    {
+        bitboard bit = bits & -bits;
+        int nibble = packed->pieces[index / 2] >> (index % 2 * 4);
+        planes[0] |= bit & -(bitboard)(nibble & 1);
+        planes[1] |= bit & -(bitboard)(nibble >> 1 & 1);
+        planes[2] |= bit & -(bitboard)(nibble >> 2 & 1);
+        planes[3] |= bit & -(bitboard)(nibble >> 3 & 1);
+    }
+    // squares past the 32nd nibble have no piece, leave them out entirely
+    occupied &= planes[0] | planes[1] | planes[2];
+
+    board *b = &out->board;
+    b->pawn = planes[0] & ~planes[1] & ~planes[2];
+    b->knight = ~planes[0] & planes[1] & ~planes[2];
+    b->bishop = planes[0] & planes[1] & ~planes[2];
+    b->rook = ~planes[0] & ~planes[1] & planes[2];
+    b->queen = planes[0] & ~planes[1] & planes[2];
+    b->king = ~planes[0] & planes[1] & planes[2];
+    b->white = occupied & ~planes[3];
+
+    out->metadata = packed->state;
+    if (packed->enPassant >= 16 && packed->enPassant < 24)
+    {
+        out->en_passants = 1 << (packed->enPassant - 16);
+    }
+    else if (packed->enPassant >= 40 && packed->enPassant < 48)
+    {
+        out->en_passants = 1 << (packed->enPassant - 40 + 8);
+    }
+    out->halfmove_clock = packed->halfmoveClock;
+    out->fullmove_number = packed->fullmoveNumber;
+}
+
+void packPositions(const game *positions, packedPosition *out, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        game canonical = canonicalPosition(positions[i]);
+        packCanonical(&canonical, &out[i]);
+    }
+}
+
+void unpackPositions(const packedPosition *packed, game *out, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        unpackPosition(&packed[i], &out[i]);
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef MEOWL_PACKED_H
+#define MEOWL_PACKED_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "bitboards.h"
+
+// a position in 28 bytes, for datasets and other bulk storage: the occupied
+// squares, then one nibble per occupied square in square order, then the
+// state. the layout is the same in memory and on disk (little endian).
+// the encoding is canonical, equal positions pack to equal bytes: castling
+// rights whose king or rook has left its square and en passant squares no
+// pawn can capture on are dropped
+typedef struct
+{
+    uint32_t occupancy[2]; // low and high half, not one uint64_t so the struct stays 4 byte aligned
+    uint8_t pieces[16];    // nibble per occupied square, low nibble first: PACKED_PAWN.. | PACKED_BLACK
+    uint8_t state;         // bit 7 white to move, bits 0-3 castling rights, as in game.metadata
+    uint8_t enPassant;     // square behind a pawn that just moved two squares, 0 if none
+    uint8_t halfmoveClock;
+    uint8_t fullmoveNumber; // capped at 255
+} packedPosition;
+
+#define PACKED_PAWN 1
+#define PACKED_KNIGHT 2
+#define PACKED_BISHOP 3
+#define PACKED_ROOK 4
+#define PACKED_QUEEN 5
+#define PACKED_KING 6
+#define PACKED_BLACK 8
+
+// a self-play training position, 32 bytes
+typedef struct
+{
+    packedPosition position;
+    int16_t score;  // search score in centipawns from white's side
+    uint8_t result; // game result from white's side: 0 loss, 1 draw, 2 win
+    uint8_t reserved;
+} trainingRecord;
+
+// the position packPosition actually stores, see above
+game canonicalPosition(game position);
+void packPosition(game position, packedPosition *out);
+void unpackPosition(const packedPosition *packed, game *out);
+// count positions at a time, for converting whole datasets
+void packPositions(const game *positions, packedPosition *out, size_t count);
+void unpackPositions(const packedPosition *packed, game *out, size_t count);
+
+#endif
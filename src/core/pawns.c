@@ -0,0 +1,110 @@
+#include "pawns.h"
+#include "weights.h"
+
+// **********
+// file fills
+// **********
+
+static bitboard northFill(bitboard pawns)
+{
+    pawns |= pawns << 8;
+    pawns |= pawns << 16;
+    pawns |= pawns << 32;
+    return pawns;
+}
+
+static bitboard southFill(bitboard pawns)
+{
+    pawns |= pawns >> 8;
+    pawns |= pawns >> 16;
+    pawns |= pawns >> 32;
+    return pawns;
+}
+
+// squares in front of the pawns, as seen from their side
+static bitboard frontSpan(bitboard pawns, bool white)
+{
+    return white ? northFill(SHIFT_UP(pawns)) : southFill(SHIFT_DOWN(pawns));
+}
+
+// **************
+// pawn structure
+// **************
+
+bitboard passedPawns(bitboard own, bitboard enemy, bool white)
+{
+    // squares an enemy pawn can reach or attack on its way to promotion
+    bitboard stoppers = frontSpan(enemy, !white);
+    stoppers |= SHIFT_LEFT(stoppers) | SHIFT_RIGHT(stoppers);
+    return own & ~stoppers & ~frontSpan(own, !white);
+}
+
+bitboard isolatedPawns(bitboard own)
+{
+    bitboard files = northFill(own) | southFill(own);
+    return own & ~(SHIFT_LEFT(files) | SHIFT_RIGHT(files));
+}
+
+bitboard doubledPawns(bitboard own, bool white)
+{
+    return own & frontSpan(own, !white);
+}
+
+void pawnFeatures(board board, int features[PAWN_FEATURES])
+{
+    bitboard white = board.pawn & board.white;
+    bitboard black = board.pawn & ~board.white;
+    features[PAWN_DOUBLED] =
+        numSignificantBits(doubledPawns(white, true)) - numSignificantBits(doubledPawns(black, false));
+    features[PAWN_ISOLATED] = numSignificantBits(isolatedPawns(white)) - numSignificantBits(isolatedPawns(black));
+    bitboard whitePassed = passedPawns(white, black, true);
+    bitboard blackPassed = passedPawns(black, white, false);
+    for (int rank = 0; rank < 8; rank++)
+    {
+        features[PAWN_PASSED + rank] =
+            numSignificantBits(whitePassed & RANK(rank)) - numSignificantBits(blackPassed & RANK(7 - rank));
+    }
+}
+
+// ***************
+// pawn hash table
+// ***************
+
+static const int passedTable[8] = PASSED_PAWN_TABLE;
+
+// every thread searches with its own table, zeroed at start, which is also
+// the right entry for a board without pawns
+static _Thread_local pawnEntry pawnTable[PAWN_HASH_ENTRIES];
+
+// slot of a pawn structure. the board has no incremental hash to take a key
+// from, and mixing the two bitboards is cheaper than a fresh zobrist sum
+static int pawnSlot(bitboard white, bitboard black)
+{
+    uint64_t key = white * 0x9E3779B97F4A7C15ULL ^ black * 0xC2B2AE3D27D4EB4FULL;
+    return (int)(key >> 52) & (PAWN_HASH_ENTRIES - 1);
+}
+
+const pawnEntry *probePawns(board board)
+{
+    bitboard white = board.pawn & board.white;
+    bitboard black = board.pawn & ~board.white;
+    pawnEntry *entry = &pawnTable[pawnSlot(white, black)];
+    if (entry->pawns[0] == white && entry->pawns[1] == black)
+    {
+        return entry;
+    }
+
+    int features[PAWN_FEATURES];
+    pawnFeatures(board, features);
+    int score = features[PAWN_DOUBLED] * DOUBLED_PAWN + features[PAWN_ISOLATED] * ISOLATED_PAWN;
+    for (int rank = 0; rank < 8; rank++)
+    {
+        score += features[PAWN_PASSED + rank] * passedTable[rank];
+    }
+    entry->pawns[0] = white;
+    entry->pawns[1] = black;
+    entry->passed[0] = passedPawns(white, black, true);
+    entry->passed[1] = passedPawns(black, white, false);
+    entry->score = score;
+    return entry;
+}
@@ -0,0 +1,48 @@
+#ifndef MEOWL_PAWNS_H
+#define MEOWL_PAWNS_H
+
+#include <stdint.h>
+#include "bitboards.h"
+
+// set-wise pawn structure: every function takes one side's pawns (and the
+// other side's where it matters) and returns the pawns that qualify, found
+// with file fills instead of looking at each pawn
+
+// own pawns no enemy pawn can stop or take on their way to promotion. of two
+// pawns on one file only the front one can be passed
+bitboard passedPawns(bitboard own, bitboard enemy, bool white);
+// own pawns without own pawns on the neighbouring files
+bitboard isolatedPawns(bitboard own);
+// own pawns with another own pawn in front of them on the same file
+bitboard doubledPawns(bitboard own, bool white);
+
+// indexes of the pawn structure features, each one white's count minus
+// black's. passed pawns are counted per rank, the rank seen from the pawn's
+// own side (0 to 7)
+#define PAWN_DOUBLED 0
+#define PAWN_ISOLATED 1
+#define PAWN_PASSED 2
+#define PAWN_FEATURES (PAWN_PASSED + 8)
+
+void pawnFeatures(board board, int features[PAWN_FEATURES]);
+
+// ***************
+// pawn hash table
+// ***************
+
+// entries per thread, 40 bytes each: 160 KB, small enough to stay in L2
+#define PAWN_HASH_ENTRIES 4096
+
+// the pawns themselves are the key, so a hit is always the right structure
+typedef struct
+{
+    bitboard pawns[2];  // [white, black]
+    bitboard passed[2]; // [white, black]
+    int32_t score;      // pawn structure score from white's side
+} pawnEntry;
+
+// the pawn structure of board, from the calling thread's table. worked out
+// and stored first if it is not there
+const pawnEntry *probePawns(board board);
+
+#endif
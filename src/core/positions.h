@@ -0,0 +1,9 @@
+#ifndef MEOWL_POSITIONS_H
+#define MEOWL_POSITIONS_H
+
+#define BENCH_POSITION_COUNT 50
+
+// built-in FEN corpus shared by the bench command and the benchmark tools
+extern const char *const benchPositions[BENCH_POSITION_COUNT];
+
+#endif
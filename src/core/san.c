@@ -0,0 +1,139 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "san.h"
+
+static char pieceLetter(board board, square sq)
+{
+    bitboard bit = 1ULL << sq;
+    if (board.knight & bit)
+    {
+        return 'N';
+    }
+    else if (board.bishop & bit)
+    {
+        return 'B';
+    }
+    else if (board.rook & bit)
+    {
+        return 'R';
+    }
+    else if (board.queen & bit)
+    {
+        return 'Q';
+    }
+    else if (board.king & bit)
+    {
+        return 'K';
+    }
+    return 0;
+}
+
+void moveToSan(game game, move played, char *out)
+{
+    char *c = out;
+    char piece = pieceLetter(game.board, played.original);
+    bitboard to = 1ULL << played.next;
+    bool capture = (getPieces(game.board) & to) || (piece == 0 && played.original % 8 != played.next % 8);
+    move *moves = getValidMoves(game);
+
+    if (piece == 'K' && (played.next - played.original == 2 || played.original - played.next == 2))
+    {
+        strcpy(c, played.next > played.original ? "O-O" : "O-O-O");
+        c += strlen(c);
+    }
+    else
+    {
+        if (piece == 0)
+        {
+            if (capture)
+            {
+                *c++ = 'a' + played.original % 8;
+            }
+        }
+        else
+        {
+            *c++ = piece;
+            // disambiguate between pieces of the same kind reaching the same square
+            bool ambiguous = false;
+            bool sameFile = false;
+            bool sameRank = false;
+            for (int i = 0; moves[i].original != -1; i++)
+            {
+                if (moves[i].next == played.next && moves[i].original != played.original &&
+                    pieceLetter(game.board, moves[i].original) == piece)
+                {
+                    ambiguous = true;
+                    sameFile |= moves[i].original % 8 == played.original % 8;
+                    sameRank |= moves[i].original / 8 == played.original / 8;
+                }
+            }
+            if (ambiguous && (!sameFile || sameRank))
+            {
+                *c++ = 'a' + played.original % 8;
+            }
+            if (ambiguous && sameFile)
+            {
+                *c++ = '1' + played.original / 8;
+            }
+        }
+        if (capture)
+        {
+            *c++ = 'x';
+        }
+        *c++ = 'a' + played.next % 8;
+        *c++ = '1' + played.next / 8;
+        if (played.promotion)
+        {
+            *c++ = '=';
+            *c++ = played.promotion - 32;
+        }
+    }
+    free(moves);
+
+    game.moves = (list_t){0, 0, 0};
+    executeMove(&game, played);
+    if (inCheck(game))
+    {
+        *c++ = getNumValidMoves(game) == 0 ? '#' : '+';
+    }
+    *c = 0;
+}
+
+// copies a SAN string without check marks, annotations or the "=" of promotions
+static void stripSan(const char *san, char *out, int size)
+{
+    int length = 0;
+    for (; *san != 0 && *san != ' ' && *san != ',' && *san != ';' && length < size - 1; san++)
+    {
+        if (*san == '+' || *san == '#' || *san == '!' || *san == '?' || *san == '=')
+        {
+            continue;
+        }
+        out[length++] = *san == '0' ? 'O' : *san; // "0-0" is sometimes used for castling
+    }
+    out[length] = 0;
+}
+
+move sanToMove(game game, const char *san)
+{
+    char wanted[SAN_MAX + 4];
+    char candidate[SAN_MAX];
+    char stripped[SAN_MAX + 4];
+    stripSan(san, wanted, sizeof(wanted));
+
+    move found = (move){-1, -1, 0};
+    move *moves = getValidMoves(game);
+    for (int i = 0; moves[i].original != -1; i++)
+    {
+        moveToSan(game, moves[i], candidate);
+        stripSan(candidate, stripped, sizeof(stripped));
+        if (strcmp(stripped, wanted) == 0)
+        {
+            found = moves[i];
+            break;
+        }
+    }
+    free(moves);
+    return found;
+}
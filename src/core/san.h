@@ -0,0 +1,16 @@
+#ifndef MEOWL_SAN_H
+#define MEOWL_SAN_H
+
+#include "bitboards.h"
+
+// longest SAN move ("Qa1xh8+" style with promotion) plus terminator
+#define SAN_MAX 10
+
+// writes a legal move in standard algebraic notation (e.g. "Nbd7", "exd6", "e8=Q+", "O-O")
+void moveToSan(game game, move played, char *out);
+
+// finds the legal move matching a SAN string, ignoring check marks and annotations.
+// returns a move with original == -1 if there is none
+move sanToMove(game game, const char *san);
+
+#endif
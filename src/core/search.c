@@ -0,0 +1,440 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "search.h"
+#include "eval.h"
+#include "attacks.h"
+#include "tbprobe.h"
+#include "egtb.h"
+#include "timeman.h"
+
+// nodes between clock reads, reading the clock every node is measurable
+#define CLOCK_CHECK_NODES 1024
+
+typedef struct
+{
+    searchLimits limits;
+    atomic_bool *stop;
+    int64_t startTime;
+    uint64_t nodes;
+    uint64_t tbHits;
+    bool stopped;
+    move pv[MAX_PLY][MAX_PLY];
+    int pvLength[MAX_PLY];
+    move rootBest;
+    // root moves left after tablebase filtering, all moves when rootCount is 0
+    move rootMoves[MAX_MOVES];
+    int rootCount;
+} searchState;
+
+int64_t getTimeMs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+// *************
+// search checks
+// *************
+
+// the stop flag is polled every node, the clock only every CLOCK_CHECK_NODES nodes
+static bool shouldStop(searchState *state)
+{
+    if (state->stopped)
+    {
+        return true;
+    }
+    if (state->stop && atomic_load_explicit(state->stop, memory_order_relaxed))
+    {
+        state->stopped = true;
+    }
+    else if (state->limits.nodes && state->nodes >= state->limits.nodes)
+    {
+        state->stopped = true;
+    }
+    else if (state->limits.time && state->nodes % CLOCK_CHECK_NODES == 0 && getTimeMs() - state->startTime >= state->limits.time)
+    {
+        state->stopped = true;
+    }
+    return state->stopped;
+}
+
+static bool isCapture(board board, move move)
+{
+    bitboard to = 1ULL << move.next;
+    return (getPieces(board) & to) || ((board.pawn >> move.original & 1) && move.original % 8 != move.next % 8);
+}
+
+static bool sameMove(move a, move b)
+{
+    return a.original == b.original && a.next == b.next && a.promotion == b.promotion;
+}
+
+static bool isRootMove(const searchState *state, move move)
+{
+    for (int i = 0; i < state->rootCount; i++)
+    {
+        if (sameMove(state->rootMoves[i], move))
+        {
+            return true;
+        }
+    }
+    return state->rootCount == 0;
+}
+
+// *************
+// move ordering
+// *************
+
+// best move of the previous iteration first, then captures by most valuable
+// victim / least valuable attacker, then queen promotions
+static int scoreMove(board board, move move, const searchState *state, int ply)
+{
+    if (ply == 0 && sameMove(move, state->rootBest))
+    {
+        return 1000000;
+    }
+    int score = 0;
+    if (isCapture(board, move))
+    {
+        int victim = pieceValue(board, move.next);
+        if (victim == 0)
+        {
+            victim = PAWN_VALUE; // en passant
+        }
+        score += 10000 + victim * 10 - pieceValue(board, move.original) / 10;
+    }
+    if (move.promotion == 'q')
+    {
+        score += 9000;
+    }
+    return score;
+}
+
+static int orderMoves(board board, move *moves, const searchState *state, int ply)
+{
+    int scores[MAX_MOVES];
+    int count = 0;
+    while (moves[count].original != -1)
+    {
+        scores[count] = scoreMove(board, moves[count], state, ply);
+        count++;
+    }
+    // insertion sort, move lists are short
+    for (int i = 1; i < count; i++)
+    {
+        move m = moves[i];
+        int s = scores[i];
+        int j = i - 1;
+        while (j >= 0 && scores[j] < s)
+        {
+            moves[j + 1] = moves[j];
+            scores[j + 1] = scores[j];
+            j--;
+        }
+        moves[j + 1] = m;
+        scores[j + 1] = s;
+    }
+    return count;
+}
+
+// ******
+// search
+// ******
+
+static int quiescence(searchState *state, game position, int ply, int alpha, int beta)
+{
+    state->nodes++;
+    if (shouldStop(state))
+    {
+        return 0;
+    }
+
+    int standPat = evaluate(position);
+    if (ply >= MAX_PLY - 1 || standPat >= beta)
+    {
+        return standPat;
+    }
+    if (standPat > alpha)
+    {
+        alpha = standPat;
+    }
+
+    move *moves = getValidMoves(position);
+    int count = orderMoves(position.board, moves, state, ply);
+    for (int i = 0; i < count; i++)
+    {
+        if (!isCapture(position.board, moves[i]) && moves[i].promotion != 'q')
+        {
+            continue;
+        }
+        game child = position;
+        executeMove(&child, moves[i]);
+        int score = -quiescence(state, child, ply + 1, -beta, -alpha);
+        if (state->stopped)
+        {
+            break;
+        }
+        if (score > alpha)
+        {
+            alpha = score;
+            if (alpha >= beta)
+            {
+                break;
+            }
+        }
+    }
+    free(moves);
+    return alpha;
+}
+
+static int alphaBeta(searchState *state, game position, int depth, int ply, int alpha, int beta)
+{
+    state->pvLength[ply] = ply;
+    if (depth <= 0)
+    {
+        return quiescence(state, position, ply, alpha, beta);
+    }
+
+    state->nodes++;
+    if (ply > 0 && shouldStop(state))
+    {
+        return 0;
+    }
+    if (ply >= MAX_PLY - 1)
+    {
+        return evaluate(position);
+    }
+
+    // our own tables know the exact distance to mate. mates too long to be
+    // reported as mate scores are still scored as known wins
+    if (ply > 0 && egtbLargest() > 0)
+    {
+        bool found;
+        int value = egtbProbe(position, &found);
+        if (found)
+        {
+            state->tbHits++;
+            if (value == EGTB_DRAW)
+            {
+                return 0;
+            }
+            int mateIn = ply + EGTB_PLIES(value);
+            int mateScore = mateIn < MAX_PLY ? MATE_SCORE - mateIn : TB_WIN_SCORE - ply;
+            return EGTB_IS_WIN(value) ? mateScore : -mateScore;
+        }
+    }
+
+    // right after a capture or pawn move the tablebases know the result.
+    // probing later in the fifty move count would lose track of it
+    if (ply > 0 && position.halfmove_clock == 0 && tbLargest() > 0)
+    {
+        bool success;
+        int wdl = tbProbeWdl(position, &success);
+        if (success)
+        {
+            state->tbHits++;
+            return wdl == WDL_WIN ? TB_WIN_SCORE - ply : wdl == WDL_LOSS ? -TB_WIN_SCORE + ply : wdl;
+        }
+    }
+
+    // the checkers found while filtering the moves also tell mate from stalemate
+    attackInfo info;
+    initAttackInfo(&info, position);
+    move *moves = getLegalMoves(position, &info);
+    int count = orderMoves(position.board, moves, state, ply);
+    if (count == 0)
+    {
+        free(moves);
+        return getCheckers(&info) ? -MATE_SCORE + ply : 0;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        if (ply == 0 && !isRootMove(state, moves[i]))
+        {
+            continue;
+        }
+        game child = position;
+        executeMove(&child, moves[i]);
+        int score = -alphaBeta(state, child, depth - 1, ply + 1, -beta, -alpha);
+        if (state->stopped)
+        {
+            break;
+        }
+        if (score > alpha)
+        {
+            alpha = score;
+            state->pv[ply][ply] = moves[i];
+            for (int next = ply + 1; next < state->pvLength[ply + 1]; next++)
+            {
+                state->pv[ply][next] = state->pv[ply + 1][next];
+            }
+            state->pvLength[ply] = state->pvLength[ply + 1];
+            if (alpha >= beta)
+            {
+                break;
+            }
+        }
+    }
+    free(moves);
+    return alpha;
+}
+
+move search(game game, searchLimits limits, atomic_bool *stop, searchCallback onIteration, void *data, searchInfo *result)
+{
+    searchState *state = (searchState *)calloc(1, sizeof(searchState));
+    state->limits = limits;
+    state->stop = stop;
+    state->startTime = getTimeMs();
+    state->rootBest = (move){-1, -1, 0};
+
+    searchInfo info = {0};
+    move best = (move){-1, -1, 0};
+
+    // fall back to any legal move if the first iteration gets interrupted
+    move *rootMoves = getValidMoves(game);
+    best = rootMoves[0];
+
+    // in tablebase positions only search the moves that keep the best result
+    if (tbLargest() > 0 && best.original != -1)
+    {
+        int count = 0;
+        while (rootMoves[count].original != -1)
+        {
+            count++;
+        }
+        int kept = tbFilterRootMoves(game, rootMoves, count);
+        if (kept < count)
+        {
+            state->rootCount = kept;
+            memcpy(state->rootMoves, rootMoves, kept * sizeof(move));
+            best = rootMoves[0];
+        }
+    }
+    free(rootMoves);
+
+    int stableIterations = 0;
+    int maxDepth = limits.depth > 0 && limits.depth < MAX_PLY ? limits.depth : MAX_PLY - 1;
+    for (int depth = 1; depth <= maxDepth && best.original != -1; depth++)
+    {
+        int score = alphaBeta(state, game, depth, 0, -INFINITE_SCORE, INFINITE_SCORE);
+        if (state->stopped || state->pvLength[0] == 0)
+        {
+            break;
+        }
+
+        stableIterations = depth > 1 && sameMove(best, state->pv[0][0]) ? stableIterations + 1 : 0;
+        int scoreDrop = depth > 1 ? info.score - score : 0;
+        best = state->pv[0][0];
+        state->rootBest = best;
+
+        info.depth = depth;
+        info.score = score;
+        info.nodes = state->nodes;
+        info.tbHits = state->tbHits;
+        info.time = getTimeMs() - state->startTime;
+        info.pvLength = state->pvLength[0];
+        for (int i = 0; i < info.pvLength; i++)
+        {
+            info.pv[i] = state->pv[0][i];
+        }
+        if (onIteration)
+        {
+            onIteration(&info, data);
+        }
+
+        // the next iteration takes longer than all the previous ones, so stop
+        // once the soft limit for this position's stability has been used
+        if (limits.softTime && info.time * 100 >= limits.softTime * softTimeScale(stableIterations, scoreDrop))
+        {
+            break;
+        }
+    }
+
+    // nodes searched by an interrupted iteration still count
+    info.nodes = state->nodes;
+    info.tbHits = state->tbHits;
+    info.time = getTimeMs() - state->startTime;
+    if (result)
+    {
+        *result = info;
+    }
+    free(state);
+    return best;
+}
+
+// quiescence that also returns the position its best line ends in
+static int quietSearch(searchState *state, game position, int ply, int alpha, int beta, game *leaf)
+{
+    *leaf = position;
+    int standPat = evaluate(position);
+    if (ply >= MAX_PLY - 1 || standPat >= beta)
+    {
+        return standPat;
+    }
+    if (standPat > alpha)
+    {
+        alpha = standPat;
+    }
+
+    move *moves = getValidMoves(position);
+    int count = orderMoves(position.board, moves, state, ply);
+    for (int i = 0; i < count; i++)
+    {
+        if (!isCapture(position.board, moves[i]) && moves[i].promotion != 'q')
+        {
+            continue;
+        }
+        game child = position;
+        game childLeaf;
+        executeMove(&child, moves[i]);
+        int score = -quietSearch(state, child, ply + 1, -beta, -alpha, &childLeaf);
+        if (score > alpha)
+        {
+            alpha = score;
+            *leaf = childLeaf;
+            if (alpha >= beta)
+            {
+                break;
+            }
+        }
+    }
+    free(moves);
+    return alpha;
+}
+
+game quietPosition(game position)
+{
+    searchState *state = (searchState *)calloc(1, sizeof(searchState));
+    state->rootBest = (move){-1, -1, 0};
+    game leaf;
+    quietSearch(state, position, 0, -INFINITE_SCORE, INFINITE_SCORE, &leaf);
+    free(state);
+    return leaf;
+}
+
+uint64_t perft(game position, int depth)
+{
+    if (depth == 0)
+    {
+        return 1;
+    }
+    move *moves = getValidMoves(position);
+    uint64_t nodes = 0;
+    for (int i = 0; moves[i].original != -1; i++)
+    {
+        if (depth == 1)
+        {
+            nodes++;
+            continue;
+        }
+        game child = position;
+        executeMove(&child, moves[i]);
+        nodes += perft(child, depth - 1);
+    }
+    free(moves);
+    return nodes;
+}
@@ -0,0 +1,53 @@
+#ifndef MEOWL_SEARCH_H
+#define MEOWL_SEARCH_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "bitboards.h"
+
+#define MAX_PLY 64
+#define INFINITE_SCORE 32000
+#define MATE_SCORE 31000
+// scores beyond this are "mate in n"
+#define MATE_BOUND (MATE_SCORE - MAX_PLY)
+// tablebase wins, below any mate score
+#define TB_WIN_SCORE (MATE_BOUND - 1)
+
+typedef struct
+{
+    int depth;        // 0 = no limit
+    uint64_t nodes;   // 0 = no limit
+    int64_t time;     // milliseconds, 0 = no limit. aborts the running iteration
+    int64_t softTime; // milliseconds, 0 = no limit. no new iteration starts past it, scaled by stability
+} searchLimits;
+
+typedef struct
+{
+    int depth;
+    int score;
+    uint64_t nodes;
+    uint64_t tbHits;
+    int64_t time; // milliseconds since the search started
+    move pv[MAX_PLY];
+    int pvLength;
+} searchInfo;
+
+// called after every completed iteration
+typedef void (*searchCallback)(const searchInfo *info, void *data);
+
+int64_t getTimeMs(void);
+
+// iterative deepening alpha-beta search. stop may be set from another thread
+// to abort; onIteration and result may be NULL. returns the best move, or a
+// move with original == -1 when there are no legal moves.
+move search(game game, searchLimits limits, atomic_bool *stop, searchCallback onIteration, void *data, searchInfo *result);
+
+// the position at the end of the quiescence search's best line, where the
+// side to move prefers standing pat over any capture. tuning uses these so
+// that evaluate() never sees a piece hanging
+game quietPosition(game position);
+
+// number of leaf nodes of the legal move tree, for checking move generation
+uint64_t perft(game position, int depth);
+
+#endif
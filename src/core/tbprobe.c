@@ -0,0 +1,1648 @@
+/*
+  Syzygy tablebase probing for Meowl, adapted to C and to Meowl's board from
+  src/syzygy/tbprobe.cpp of Stockfish, which builds on the original probing
+  code by Ronald de Man.
+
+  Copyright (C) 2004-2024 The Stockfish developers (see Stockfish's AUTHORS file)
+  Copyright (C) 2013 Ronald de Man
+
+  This file is free software: you can redistribute it and/or modify it under
+  the terms of the GNU General Public License as published by the Free
+  Software Foundation, either version 3 of the License, or (at your option)
+  any later version.
+
+  This file is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+  A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along with
+  this file. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "tbprobe.h"
+
+// Syzygy tables are compressed per table with canonical Huffman codes over
+// "recursive pairing" symbols. a position is turned into an index by mapping it
+// into a canonical orientation and encoding groups of pieces with binomial
+// coefficients, then the block holding that index is decompressed.
+//
+// WDL tables give win/draw/loss for both sides to move. DTZ tables give the
+// distance to the next capture or pawn move for one side to move only. neither
+// stores reliable values for positions where a capture (or for DTZ a pawn move)
+// is best, so probes first search those moves themselves.
+
+#define TB_PIECES 6
+#define TB_MAX_TABLES 1024
+#define TB_HASH_SIZE 4096
+#define MAX_DTZ (1 << 18)
+
+enum
+{
+    TB_WDL,
+    TB_DTZ
+};
+
+// per table flags, all but the last one only used by DTZ tables
+enum
+{
+    FLAG_STM = 1,
+    FLAG_MAPPED = 2,
+    FLAG_WIN_PLIES = 4,
+    FLAG_LOSS_PLIES = 8,
+    FLAG_WIDE = 16,
+    FLAG_SINGLE_VALUE = 128
+};
+
+enum
+{
+    PROBE_FAIL,
+    PROBE_OK,
+    PROBE_CHANGE_STM,         // DTZ table stores the other side to move
+    PROBE_ZEROING_BEST_MOVE   // best move is a capture or pawn move, table value is unreliable
+};
+
+// piece codes as stored in the files: white 1-6, black 9-14
+enum
+{
+    PAWN = 1,
+    KNIGHT,
+    BISHOP,
+    ROOK,
+    QUEEN,
+    KING
+};
+
+typedef uint16_t symbol;
+
+// indexing data for one side to move (and one leading pawn file) of a table
+typedef struct
+{
+    uint8_t flags;
+    uint8_t maxSymLen;
+    uint8_t minSymLen;
+    uint32_t numBlocks;
+    size_t blockSize;
+    size_t span;                   // every span values there is a sparse index entry
+    const uint8_t *lowestSym;      // little endian, lowest symbol of each code length
+    const uint8_t *btree;          // 3 bytes per symbol: 12 bit left and right children
+    const uint8_t *blockLength;    // little endian uint16, values per block minus one
+    uint32_t blockLengthSize;
+    const uint8_t *sparseIndex;    // 6 bytes per entry: uint32 block, uint16 offset
+    size_t sparseIndexSize;
+    const uint8_t *data;           // the Huffman coded blocks
+    const uint8_t *end;            // end of the mapping, nothing past it is read
+    uint64_t *base64;              // lowest code of each length, left aligned to 64 bits
+    uint8_t *symlen;               // values each symbol expands to, minus one
+    int symbolCount;
+    uint8_t pieces[TB_PIECES];
+    uint64_t groupIdx[TB_PIECES + 1];
+    int groupLen[TB_PIECES + 1];
+    uint16_t mapIdx[4];            // DTZ value maps for win, loss, cursed win, blessed loss
+} pairsData;
+
+typedef struct
+{
+    atomic_bool ready;
+    int type;
+    char name[TB_PIECES + 2];      // "KRPvKR"
+    void *baseAddress;
+    size_t mapping;
+    const uint8_t *map;            // DTZ value maps
+    size_t mapSize;                // bytes of DTZ value maps
+    uint64_t key;                  // material with the stronger side white
+    uint64_t key2;                 // and with colours swapped
+    int pieceCount;
+    bool hasPawns;
+    bool hasUniquePieces;
+    uint8_t pawnCount[2];          // leading colour, other colour
+    pairsData items[2][4];         // [side to move][leading pawn file]
+} tbTable;
+
+typedef struct
+{
+    uint64_t key;
+    int index;
+} tbHashEntry;
+
+static char *tbPaths = NULL;
+static tbTable *wdlTables = NULL;
+static tbTable *dtzTables = NULL;
+static int tableCount = 0;
+static int largest = 0;
+static tbHashEntry tbHash[TB_HASH_SIZE];
+static pthread_mutex_t mappingLock = PTHREAD_MUTEX_INITIALIZER;
+
+static int mapPawns[64];
+static int mapB1H1H7[64];
+static int mapA1D1D4[64];
+static int mapKK[10][64];
+static uint64_t binomial[TB_PIECES][64];
+static uint64_t leadPawnIdx[TB_PIECES][64];
+static uint64_t leadPawnsSize[TB_PIECES][4];
+static bool indicesReady = false;
+
+// ******************
+// byte order helpers
+// ******************
+
+static uint16_t readLE16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static uint32_t readLE32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint32_t readBE32(const uint8_t *p)
+{
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | (uint32_t)p[3];
+}
+
+static uint64_t readBE64(const uint8_t *p)
+{
+    return (uint64_t)readBE32(p) << 32 | readBE32(p + 4);
+}
+
+// true if size bytes from data are inside the mapping that ends at end
+static bool fits(const uint8_t *data, uint64_t size, const uint8_t *end)
+{
+    return data <= end && size <= (uint64_t)(end - data);
+}
+
+static symbol btreeLeft(const pairsData *d, symbol s)
+{
+    const uint8_t *lr = d->btree + 3 * s;
+    return (symbol)((lr[1] & 0xF) << 8 | lr[0]);
+}
+
+static symbol btreeRight(const pairsData *d, symbol s)
+{
+    const uint8_t *lr = d->btree + 3 * s;
+    return (symbol)(lr[2] << 4 | lr[1] >> 4);
+}
+
+// *************
+// board helpers
+// *************
+
+static int popLsb(bitboard *b)
+{
+    int s = __builtin_ctzll(*b);
+    *b &= *b - 1;
+    return s;
+}
+
+static int offA1H8(int s)
+{
+    return (s >> 3) - (s & 7);
+}
+
+static int pieceOn(board b, int s)
+{
+    bitboard mask = 1ULL << s;
+    int colour = b.white & mask ? 0 : 8;
+    if (b.pawn & mask)
+    {
+        return PAWN | colour;
+    }
+    if (b.knight & mask)
+    {
+        return KNIGHT | colour;
+    }
+    if (b.bishop & mask)
+    {
+        return BISHOP | colour;
+    }
+    if (b.rook & mask)
+    {
+        return ROOK | colour;
+    }
+    if (b.queen & mask)
+    {
+        return QUEEN | colour;
+    }
+    return KING | colour;
+}
+
+// 4 bits per piece kind, white in the low half
+static uint64_t materialKey(const int counts[16])
+{
+    uint64_t key = 0;
+    for (int piece = PAWN; piece <= KING; piece++)
+    {
+        key |= (uint64_t)counts[piece] << (4 * (piece - 1));
+        key |= (uint64_t)counts[piece | 8] << (4 * (piece - 1) + 32);
+    }
+    return key;
+}
+
+static void countPieces(board b, int counts[16])
+{
+    memset(counts, 0, 16 * sizeof(int));
+    bitboard pieces = getPieces(b);
+    while (pieces)
+    {
+        counts[pieceOn(b, popLsb(&pieces))]++;
+    }
+}
+
+static uint64_t positionKey(board b)
+{
+    int counts[16];
+    countPieces(b, counts);
+    return materialKey(counts);
+}
+
+static bool isPawnMove(board b, move played)
+{
+    return b.pawn >> played.original & 1;
+}
+
+static bool isCapture(board b, move played)
+{
+    return (getPieces(b) >> played.next & 1) || (isPawnMove(b, played) && played.original % 8 != played.next % 8);
+}
+
+// ************
+// index tables
+// ************
+
+static void initIndices(void)
+{
+    int code = 0;
+    for (int s = 0; s < 64; s++)
+    {
+        if (offA1H8(s) < 0)
+        {
+            mapB1H1H7[s] = code++;
+        }
+    }
+
+    // a1-d1-d4 triangle to 0..9, the diagonal squares last
+    int diagonal[4];
+    int diagonalCount = 0;
+    code = 0;
+    for (int s = 0; s <= 27; s++)
+    {
+        if (offA1H8(s) < 0 && (s & 7) <= 3)
+        {
+            mapA1D1D4[s] = code++;
+        }
+        else if (offA1H8(s) == 0 && (s & 7) <= 3)
+        {
+            diagonal[diagonalCount++] = s;
+        }
+    }
+    for (int i = 0; i < diagonalCount; i++)
+    {
+        mapA1D1D4[diagonal[i]] = code++;
+    }
+
+    // the 462 legal placements of two kings with the first in the triangle.
+    // with the first king on the diagonal the second may not be above it
+    int bothOnDiagonal[64][2];
+    int bothCount = 0;
+    code = 0;
+    for (int idx = 0; idx < 10; idx++)
+    {
+        for (int s1 = 0; s1 <= 27; s1++)
+        {
+            if (mapA1D1D4[s1] != idx || (idx == 0 && s1 != 1) || (s1 & 7) > 3 || offA1H8(s1) > 0)
+            {
+                continue;
+            }
+            for (int s2 = 0; s2 < 64; s2++)
+            {
+                int fileDistance = abs((s1 & 7) - (s2 & 7));
+                int rankDistance = abs((s1 >> 3) - (s2 >> 3));
+                if (fileDistance <= 1 && rankDistance <= 1)
+                {
+                    continue;
+                }
+                else if (!offA1H8(s1) && offA1H8(s2) > 0)
+                {
+                    continue;
+                }
+                else if (!offA1H8(s1) && !offA1H8(s2))
+                {
+                    bothOnDiagonal[bothCount][0] = idx;
+                    bothOnDiagonal[bothCount++][1] = s2;
+                }
+                else
+                {
+                    mapKK[idx][s2] = code++;
+                }
+            }
+        }
+    }
+    for (int i = 0; i < bothCount; i++)
+    {
+        mapKK[bothOnDiagonal[i][0]][bothOnDiagonal[i][1]] = code++;
+    }
+
+    // pascal's triangle, binomial[k][n] ways to pick k of n squares
+    binomial[0][0] = 1;
+    for (int n = 1; n < 64; n++)
+    {
+        for (int k = 0; k < TB_PIECES && k <= n; k++)
+        {
+            binomial[k][n] = (k > 0 ? binomial[k - 1][n - 1] : 0) + (k < n ? binomial[k][n - 1] : 0);
+        }
+    }
+
+    // a2-h7 to 47..0, the leading pawn is the one with the highest value:
+    // nearest the edge and then lowest rank
+    int available = 47;
+    for (int leadPawns = 1; leadPawns < TB_PIECES; leadPawns++)
+    {
+        for (int file = 0; file < 4; file++)
+        {
+            uint64_t idx = 0;
+            for (int rank = 1; rank <= 6; rank++)
+            {
+                int s = rank * 8 + file;
+                if (leadPawns == 1)
+                {
+                    mapPawns[s] = available--;
+                    mapPawns[s ^ 7] = available--;
+                }
+                leadPawnIdx[leadPawns][s] = idx;
+                idx += binomial[leadPawns - 1][mapPawns[s]];
+            }
+            leadPawnsSize[leadPawns][file] = idx;
+        }
+    }
+    indicesReady = true;
+}
+
+// ******************
+// table registration
+// ******************
+
+static bool findTableFile(const char *name, const char *extension, char *path, size_t size)
+{
+    if (tbPaths == NULL)
+    {
+        return false;
+    }
+    const char *directory = tbPaths;
+    while (*directory)
+    {
+        size_t length = strcspn(directory, ":");
+        if (length > 0)
+        {
+            snprintf(path, size, "%.*s/%s%s", (int)length, directory, name, extension);
+            if (access(path, R_OK) == 0)
+            {
+                return true;
+            }
+        }
+        directory += length;
+        if (*directory == ':')
+        {
+            directory++;
+        }
+    }
+    return false;
+}
+
+static void insertKey(uint64_t key, int index)
+{
+    int slot = (int)((key * 0x9E3779B97F4A7C15ULL) >> 52) & (TB_HASH_SIZE - 1);
+    while (tbHash[slot].index >= 0 && tbHash[slot].key != key)
+    {
+        slot = (slot + 1) & (TB_HASH_SIZE - 1);
+    }
+    tbHash[slot].key = key;
+    tbHash[slot].index = index;
+}
+
+static int findTable(uint64_t key)
+{
+    int slot = (int)((key * 0x9E3779B97F4A7C15ULL) >> 52) & (TB_HASH_SIZE - 1);
+    while (tbHash[slot].index >= 0)
+    {
+        if (tbHash[slot].key == key)
+        {
+            return tbHash[slot].index;
+        }
+        slot = (slot + 1) & (TB_HASH_SIZE - 1);
+    }
+    return -1;
+}
+
+// pieces is a list of kinds starting with the white king, the second king
+// starts black's pieces. e.g. {KING, ROOK, KING} for KRvK
+static void addTable(const int *pieces, int count)
+{
+    char name[TB_PIECES + 2];
+    const char pieceChars[] = " PNBRQK";
+    int length = 0;
+    int counts[16] = {0};
+    int colour = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (pieces[i] == KING && i > 0)
+        {
+            name[length++] = 'v';
+            colour = 8;
+        }
+        name[length++] = pieceChars[pieces[i]];
+        counts[pieces[i] | colour]++;
+    }
+    name[length] = 0;
+
+    char path[4096];
+    if (tableCount == TB_MAX_TABLES || !findTableFile(name, ".rtbw", path, sizeof(path)))
+    {
+        return; // only the WDL file needs to exist
+    }
+
+    tbTable *wdl = &wdlTables[tableCount];
+    memset(wdl, 0, sizeof(*wdl));
+    atomic_init(&wdl->ready, false);
+    wdl->type = TB_WDL;
+    strcpy(wdl->name, name);
+    wdl->key = materialKey(counts);
+    int swapped[16];
+    for (int i = 0; i < 8; i++)
+    {
+        swapped[i] = counts[i + 8];
+        swapped[i + 8] = counts[i];
+    }
+    wdl->key2 = materialKey(swapped);
+    wdl->pieceCount = count;
+    wdl->hasPawns = counts[PAWN] || counts[PAWN | 8];
+    for (int piece = PAWN; piece < KING; piece++)
+    {
+        if (counts[piece] == 1 || counts[piece | 8] == 1)
+        {
+            wdl->hasUniquePieces = true;
+        }
+    }
+
+    // the side with fewer pawns leads, it compresses better
+    bool whiteLeads = !counts[PAWN | 8] || (counts[PAWN] && counts[PAWN | 8] >= counts[PAWN]);
+    wdl->pawnCount[0] = whiteLeads ? counts[PAWN] : counts[PAWN | 8];
+    wdl->pawnCount[1] = whiteLeads ? counts[PAWN | 8] : counts[PAWN];
+
+    tbTable *dtz = &dtzTables[tableCount];
+    *dtz = *wdl;
+    atomic_init(&dtz->ready, false);
+    dtz->type = TB_DTZ;
+
+    insertKey(wdl->key, tableCount);
+    insertKey(wdl->key2, tableCount);
+    tableCount++;
+    if (count > largest)
+    {
+        largest = count;
+    }
+}
+
+// frees what setupTable allocated, also for tables that turned out to be corrupt
+static void freePairs(tbTable *table)
+{
+    for (int side = 0; side < 2; side++)
+    {
+        for (int file = 0; file < 4; file++)
+        {
+            free(table->items[side][file].base64);
+            free(table->items[side][file].symlen);
+            table->items[side][file].base64 = NULL;
+            table->items[side][file].symlen = NULL;
+        }
+    }
+}
+
+void tbFree(void)
+{
+    for (int i = 0; i < tableCount; i++)
+    {
+        tbTable *tables[2] = {&wdlTables[i], &dtzTables[i]};
+        for (int t = 0; t < 2; t++)
+        {
+            if (tables[t]->baseAddress != NULL)
+            {
+                munmap(tables[t]->baseAddress, tables[t]->mapping);
+            }
+            freePairs(tables[t]);
+        }
+    }
+    free(wdlTables);
+    free(dtzTables);
+    free(tbPaths);
+    wdlTables = NULL;
+    dtzTables = NULL;
+    tbPaths = NULL;
+    tableCount = 0;
+    largest = 0;
+}
+
+int tbInit(const char *paths)
+{
+    tbFree();
+    for (int i = 0; i < TB_HASH_SIZE; i++)
+    {
+        tbHash[i].index = -1;
+    }
+    if (paths == NULL || *paths == 0 || strcmp(paths, "<empty>") == 0)
+    {
+        return 0;
+    }
+    if (!indicesReady)
+    {
+        initIndices();
+    }
+    tbPaths = strdup(paths);
+    wdlTables = (tbTable *)calloc(TB_MAX_TABLES, sizeof(tbTable));
+    dtzTables = (tbTable *)calloc(TB_MAX_TABLES, sizeof(tbTable));
+
+    // every material combination of up to 6 pieces, stronger side first
+    for (int p1 = PAWN; p1 < KING; p1++)
+    {
+        addTable((int[]){KING, p1, KING}, 3);
+        for (int p2 = PAWN; p2 <= p1; p2++)
+        {
+            addTable((int[]){KING, p1, p2, KING}, 4);
+            addTable((int[]){KING, p1, KING, p2}, 4);
+            for (int p3 = PAWN; p3 < KING; p3++)
+            {
+                addTable((int[]){KING, p1, p2, KING, p3}, 5);
+            }
+            for (int p3 = PAWN; p3 <= p2; p3++)
+            {
+                addTable((int[]){KING, p1, p2, p3, KING}, 5);
+                for (int p4 = PAWN; p4 <= p3; p4++)
+                {
+                    addTable((int[]){KING, p1, p2, p3, p4, KING}, 6);
+                }
+                for (int p4 = PAWN; p4 < KING; p4++)
+                {
+                    addTable((int[]){KING, p1, p2, p3, KING, p4}, 6);
+                }
+            }
+            for (int p3 = PAWN; p3 <= p1; p3++)
+            {
+                for (int p4 = PAWN; p4 <= (p1 == p3 ? p2 : p3); p4++)
+                {
+                    addTable((int[]){KING, p1, p2, KING, p3, p4}, 6);
+                }
+            }
+        }
+    }
+    return tableCount;
+}
+
+int tbLargest(void)
+{
+    return largest;
+}
+
+// ********************
+// table initialisation
+// ********************
+
+static pairsData *getPairs(tbTable *table, int stm, int file)
+{
+    int sides = table->type == TB_WDL ? 2 : 1;
+    return &table->items[stm % sides][table->hasPawns ? file : 0];
+}
+
+// splits the stored piece order into groups encoded together: the leading
+// group (up to 3 unique pieces, the two kings, or the leading pawns), then
+// runs of identical pieces. the order byte says in which order they nest
+static bool setGroups(tbTable *table, pairsData *d, const int order[2], int file)
+{
+    int n = 0;
+    int firstLen = table->hasPawns ? 0 : table->hasUniquePieces ? 3 : 2;
+    d->groupLen[n] = 1;
+    for (int i = 1; i < table->pieceCount; i++)
+    {
+        if (--firstLen > 0 || d->pieces[i] == d->pieces[i - 1])
+        {
+            d->groupLen[n]++;
+        }
+        else
+        {
+            d->groupLen[++n] = 1;
+        }
+    }
+    d->groupLen[++n] = 0;
+
+    bool pawnsOnBothSides = table->hasPawns && table->pawnCount[1];
+    int next = pawnsOnBothSides ? 2 : 1;
+    int freeSquares = 64 - d->groupLen[0] - (pawnsOnBothSides ? d->groupLen[1] : 0);
+    uint64_t idx = 1;
+    for (int k = 0; next < n || k == order[0] || k == order[1]; k++)
+    {
+        if (k == order[0])
+        {
+            d->groupIdx[0] = idx;
+            idx *= table->hasPawns ? leadPawnsSize[d->groupLen[0]][file] : table->hasUniquePieces ? 31332 : 462;
+        }
+        else if (k == order[1])
+        {
+            d->groupIdx[1] = idx;
+            idx *= binomial[d->groupLen[1]][48 - d->groupLen[0]];
+        }
+        else if (next < n)
+        {
+            d->groupIdx[next] = idx;
+            idx *= binomial[d->groupLen[next]][freeSquares];
+            freeSquares -= d->groupLen[next++];
+        }
+        else
+        {
+            return false; // an order past the last group
+        }
+    }
+    d->groupIdx[n] = idx;
+    return true;
+}
+
+// number of values a symbol expands to, following its pairs down to the leaves
+static uint8_t setSymlen(pairsData *d, symbol s, bool *visited)
+{
+    visited[s] = true;
+    symbol right = btreeRight(d, s);
+    if (right == 0xFFF)
+    {
+        return 0;
+    }
+    symbol left = btreeLeft(d, s);
+    if (!visited[left])
+    {
+        d->symlen[left] = setSymlen(d, left, visited);
+    }
+    if (!visited[right])
+    {
+        d->symlen[right] = setSymlen(d, right, visited);
+    }
+    return (uint8_t)(d->symlen[left] + d->symlen[right] + 1);
+}
+
+// reads the sizes and the Huffman code of one pairsData, NULL if they do
+// not fit in the file or do not make sense
+static const uint8_t *setSizes(pairsData *d, const uint8_t *data, const uint8_t *end)
+{
+    d->end = end;
+    if (!fits(data, 2, end))
+    {
+        return NULL;
+    }
+    d->flags = *data++;
+    if (d->flags & FLAG_SINGLE_VALUE)
+    {
+        d->numBlocks = 0;
+        d->span = 0;
+        d->blockLengthSize = 0;
+        d->sparseIndexSize = 0;
+        d->minSymLen = *data++; // the value every position has
+        return data;
+    }
+
+    int groups = 0;
+    while (d->groupLen[groups])
+    {
+        groups++;
+    }
+    uint64_t tableSize = d->groupIdx[groups];
+
+    if (!fits(data, 8, end) || data[0] > 31 || data[1] > 31)
+    {
+        return NULL;
+    }
+    d->blockSize = (size_t)1 << *data++;
+    d->span = (size_t)1 << *data++;
+    d->sparseIndexSize = (size_t)((tableSize + d->span - 1) / d->span);
+    uint8_t padding = *data++;
+    d->numBlocks = readLE32(data);
+    data += 4;
+    if (d->numBlocks > UINT32_MAX - padding)
+    {
+        return NULL;
+    }
+    d->blockLengthSize = d->numBlocks + padding;
+    d->maxSymLen = *data++;
+    d->minSymLen = *data++;
+    d->lowestSym = data;
+
+    // canonical Huffman codes: longer codes have lower values, so the lowest
+    // code of each length, left aligned, gives decreasing thresholds
+    int lengths = d->maxSymLen - d->minSymLen + 1;
+    if (d->minSymLen == 0 || d->maxSymLen > 32 || lengths < 1 || !fits(data, lengths * 2 + 2, end))
+    {
+        return NULL;
+    }
+    d->base64 = (uint64_t *)calloc(lengths, sizeof(uint64_t));
+    for (int i = lengths - 2; i >= 0; i--)
+    {
+        d->base64[i] = (d->base64[i + 1] + readLE16(d->lowestSym + 2 * i) - readLE16(d->lowestSym + 2 * (i + 1))) / 2;
+    }
+    for (int i = 0; i < lengths; i++)
+    {
+        d->base64[i] <<= 64 - i - d->minSymLen;
+    }
+    data += lengths * 2;
+
+    d->symbolCount = readLE16(data);
+    data += 2;
+    d->btree = data;
+    if (d->symbolCount == 0 || d->symbolCount > 0xFFF || !fits(data, d->symbolCount * 3 + (d->symbolCount & 1), end))
+    {
+        return NULL;
+    }
+    // both children of every pair have to be symbols of the table
+    for (int s = 0; s < d->symbolCount; s++)
+    {
+        if (btreeRight(d, (symbol)s) != 0xFFF &&
+            (btreeLeft(d, (symbol)s) >= d->symbolCount || btreeRight(d, (symbol)s) >= d->symbolCount))
+        {
+            return NULL;
+        }
+    }
+    d->symlen = (uint8_t *)calloc(d->symbolCount, 1);
+    bool *visited = (bool *)calloc(d->symbolCount, sizeof(bool));
+    for (int s = 0; s < d->symbolCount; s++)
+    {
+        if (!visited[s])
+        {
+            d->symlen[s] = setSymlen(d, (symbol)s, visited);
+        }
+    }
+    free(visited);
+    // a pair is longer than either child, so decoding always reaches a leaf.
+    // a cycle in the tree or a length past 255 breaks this
+    for (int s = 0; s < d->symbolCount; s++)
+    {
+        symbol right = btreeRight(d, (symbol)s);
+        if (right != 0xFFF && d->symlen[s] != d->symlen[btreeLeft(d, (symbol)s)] + d->symlen[right] + 1)
+        {
+            return NULL;
+        }
+    }
+    return data + d->symbolCount * 3 + (d->symbolCount & 1);
+}
+
+// DTZ values are stored as ranks by frequency, the maps turn them back
+static const uint8_t *setDtzMap(tbTable *table, const uint8_t *data, const uint8_t *end, int maxFile)
+{
+    table->map = data;
+    for (int file = 0; file <= maxFile; file++)
+    {
+        pairsData *d = getPairs(table, 0, file);
+        if (!(d->flags & FLAG_MAPPED))
+        {
+            continue;
+        }
+        if (d->flags & FLAG_WIDE)
+        {
+            data += (uintptr_t)data & 1;
+            for (int i = 0; i < 4; i++)
+            {
+                if (!fits(data, 2, end) || !fits(data, 2 * readLE16(data) + 2, end))
+                {
+                    return NULL;
+                }
+                d->mapIdx[i] = (uint16_t)((data - table->map) / 2 + 1);
+                data += 2 * readLE16(data) + 2;
+            }
+        }
+        else
+        {
+            for (int i = 0; i < 4; i++)
+            {
+                if (!fits(data, 1, end) || !fits(data, *data + 1, end))
+                {
+                    return NULL;
+                }
+                d->mapIdx[i] = (uint16_t)(data - table->map + 1);
+                data += *data + 1;
+            }
+        }
+    }
+    table->mapSize = (size_t)(data - table->map);
+    return data + ((uintptr_t)data & 1);
+}
+
+// the stored piece order of one pairsData has to hold the table's material,
+// with the leading pawns in front in pawn tables, or probes would look up
+// pieces that are not there
+static bool validPieces(const tbTable *table, const pairsData *d)
+{
+    int counts[16] = {0};
+    for (int k = 0; k < table->pieceCount; k++)
+    {
+        if ((d->pieces[k] & 7) < PAWN || (d->pieces[k] & 7) > KING)
+        {
+            return false;
+        }
+        counts[d->pieces[k]]++;
+    }
+    if (materialKey(counts) != table->key)
+    {
+        return false;
+    }
+    if (table->hasPawns)
+    {
+        int lead = 0;
+        while (lead < table->pieceCount && d->pieces[lead] == d->pieces[0])
+        {
+            lead++;
+        }
+        return (d->pieces[0] & 7) == PAWN && lead == counts[d->pieces[0]];
+    }
+    return true;
+}
+
+// reads the layout of the file, false if it is truncated or inconsistent.
+// every offset is checked against the end of the mapping before it is used
+static bool setupTable(tbTable *table, const uint8_t *data, const uint8_t *end)
+{
+    data++; // flags, the table already knows them from its material
+    int sides = table->type == TB_WDL && table->key != table->key2 ? 2 : 1;
+    int maxFile = table->hasPawns ? 3 : 0;
+    bool pawnsOnBothSides = table->hasPawns && table->pawnCount[1];
+
+    for (int file = 0; file <= maxFile; file++)
+    {
+        if (!fits(data, 1 + pawnsOnBothSides + table->pieceCount, end))
+        {
+            return false;
+        }
+        int order[2][2] = {{*data & 0xF, pawnsOnBothSides ? data[1] & 0xF : 0xF},
+                           {*data >> 4, pawnsOnBothSides ? data[1] >> 4 : 0xF}};
+        data += 1 + pawnsOnBothSides;
+        for (int k = 0; k < table->pieceCount; k++, data++)
+        {
+            for (int i = 0; i < sides; i++)
+            {
+                getPairs(table, i, file)->pieces[k] = i ? *data >> 4 : *data & 0xF;
+            }
+        }
+        for (int i = 0; i < sides; i++)
+        {
+            if (!validPieces(table, getPairs(table, i, file)) ||
+                !setGroups(table, getPairs(table, i, file), order[i], file))
+            {
+                return false;
+            }
+        }
+    }
+    data += (uintptr_t)data & 1;
+
+    for (int file = 0; file <= maxFile; file++)
+    {
+        for (int i = 0; i < sides && data != NULL; i++)
+        {
+            data = setSizes(getPairs(table, i, file), data, end);
+        }
+    }
+    if (data != NULL && table->type == TB_DTZ)
+    {
+        data = setDtzMap(table, data, end, maxFile);
+    }
+    if (data == NULL)
+    {
+        return false;
+    }
+    for (int file = 0; file <= maxFile; file++)
+    {
+        for (int i = 0; i < sides; i++)
+        {
+            pairsData *d = getPairs(table, i, file);
+            if (!fits(data, (uint64_t)d->sparseIndexSize * 6, end))
+            {
+                return false;
+            }
+            d->sparseIndex = data;
+            data += d->sparseIndexSize * 6;
+        }
+    }
+    for (int file = 0; file <= maxFile; file++)
+    {
+        for (int i = 0; i < sides; i++)
+        {
+            pairsData *d = getPairs(table, i, file);
+            if (!fits(data, (uint64_t)d->blockLengthSize * 2, end))
+            {
+                return false;
+            }
+            d->blockLength = data;
+            data += d->blockLengthSize * 2;
+        }
+    }
+    for (int file = 0; file <= maxFile; file++)
+    {
+        for (int i = 0; i < sides; i++)
+        {
+            pairsData *d = getPairs(table, i, file);
+            data = (const uint8_t *)(((uintptr_t)data + 0x3F) & ~(uintptr_t)0x3F);
+            if (!fits(data, (uint64_t)d->numBlocks * d->blockSize, end))
+            {
+                return false;
+            }
+            d->data = data;
+            data += (size_t)d->numBlocks * d->blockSize;
+        }
+    }
+    return true;
+}
+
+// maps the file on first use. threads may race here, the lock makes sure only
+// one of them does the work and the flag lets later probes skip the lock
+static bool mapTable(tbTable *table)
+{
+    if (atomic_load_explicit(&table->ready, memory_order_acquire))
+    {
+        return table->baseAddress != NULL;
+    }
+    pthread_mutex_lock(&mappingLock);
+    if (!atomic_load_explicit(&table->ready, memory_order_relaxed))
+    {
+        char path[4096];
+        const uint8_t magics[2][4] = {{0x71, 0xE8, 0x23, 0x5D}, {0xD7, 0x66, 0x0C, 0xA5}};
+        int fd = -1;
+        struct stat info;
+        if (findTableFile(table->name, table->type == TB_WDL ? ".rtbw" : ".rtbz", path, sizeof(path)))
+        {
+            fd = open(path, O_RDONLY);
+        }
+        if (fd >= 0 && fstat(fd, &info) == 0 && info.st_size > 16 && info.st_size % 64 == 16)
+        {
+            void *data = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            if (data != MAP_FAILED)
+            {
+                madvise(data, info.st_size, MADV_RANDOM);
+                const uint8_t *end = (const uint8_t *)data + info.st_size;
+                if (memcmp(data, magics[table->type], 4) == 0 && setupTable(table, (const uint8_t *)data + 4, end))
+                {
+                    table->baseAddress = data;
+                    table->mapping = info.st_size;
+                }
+                else
+                {
+                    freePairs(table);
+                    fprintf(stderr, "corrupted tablebase file %s\n", path);
+                    munmap(data, info.st_size);
+                }
+            }
+        }
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        atomic_store_explicit(&table->ready, true, memory_order_release);
+    }
+    pthread_mutex_unlock(&mappingLock);
+    return table->baseAddress != NULL;
+}
+
+// *************
+// decompression
+// *************
+
+// the value stored at idx, -1 if the compressed data leads outside the file
+static int decompressPairs(const pairsData *d, uint64_t idx)
+{
+    if (d->flags & FLAG_SINGLE_VALUE)
+    {
+        return d->minSymLen;
+    }
+
+    // the sparse index points at the block holding the value in the middle
+    // of each span, walk blocks from there until the one holding idx
+    uint64_t k = idx / d->span;
+    if (k >= d->sparseIndexSize)
+    {
+        return -1;
+    }
+    uint32_t block = readLE32(d->sparseIndex + 6 * k);
+    int offset = readLE16(d->sparseIndex + 6 * k + 4);
+    offset += (int)(idx % d->span) - (int)(d->span / 2);
+    while (offset < 0)
+    {
+        if (block == 0 || block > d->blockLengthSize)
+        {
+            return -1;
+        }
+        offset += readLE16(d->blockLength + 2 * --block) + 1;
+    }
+    while (true)
+    {
+        if (block >= d->blockLengthSize)
+        {
+            return -1;
+        }
+        if (offset <= readLE16(d->blockLength + 2 * block))
+        {
+            break;
+        }
+        offset -= readLE16(d->blockLength + 2 * block++) + 1;
+    }
+
+    // decode symbols until the one covering our offset
+    const uint8_t *ptr = d->data + (uint64_t)block * d->blockSize;
+    if (block >= d->numBlocks || !fits(ptr, 8, d->end))
+    {
+        return -1;
+    }
+    uint64_t buffer = readBE64(ptr);
+    ptr += 8;
+    int bufferSize = 64;
+    symbol sym;
+    while (true)
+    {
+        int length = 0;
+        while (buffer < d->base64[length])
+        {
+            length++;
+        }
+        sym = (symbol)((buffer - d->base64[length]) >> (64 - length - d->minSymLen));
+        sym += readLE16(d->lowestSym + 2 * length);
+        if (sym >= d->symbolCount)
+        {
+            return -1;
+        }
+        if (offset < d->symlen[sym] + 1)
+        {
+            break;
+        }
+        offset -= d->symlen[sym] + 1;
+        length += d->minSymLen;
+        buffer <<= length;
+        bufferSize -= length;
+        if (bufferSize <= 32)
+        {
+            if (!fits(ptr, 4, d->end))
+            {
+                return -1;
+            }
+            bufferSize += 32;
+            buffer |= (uint64_t)readBE32(ptr) << (64 - bufferSize);
+            ptr += 4;
+        }
+    }
+
+    // children of a pair are adjacent, descend to the leaf holding the value
+    while (d->symlen[sym])
+    {
+        symbol left = btreeLeft(d, sym);
+        if (offset < d->symlen[left] + 1)
+        {
+            sym = left;
+        }
+        else
+        {
+            offset -= d->symlen[left] + 1;
+            sym = btreeRight(d, sym);
+        }
+    }
+    return btreeLeft(d, sym);
+}
+
+// the table value turned into WDL or DTZ, PROBE_FAIL in result if value is
+// -1 or outside the DTZ map
+static int mapScore(tbTable *table, int file, int value, int wdl, int *result)
+{
+    if (value < 0)
+    {
+        *result = PROBE_FAIL;
+        return 0;
+    }
+    if (table->type == TB_WDL)
+    {
+        return value - 2;
+    }
+
+    const int wdlMap[] = {1, 3, 0, 2, 0};
+    pairsData *d = getPairs(table, 0, file);
+    if (d->flags & FLAG_MAPPED)
+    {
+        size_t index = (size_t)d->mapIdx[wdlMap[wdl + 2]] + value;
+        if ((d->flags & FLAG_WIDE ? 2 * index + 2 : index + 1) > table->mapSize)
+        {
+            *result = PROBE_FAIL;
+            return 0;
+        }
+        value = d->flags & FLAG_WIDE ? readLE16(table->map + 2 * index) : table->map[index];
+    }
+
+    // stored in moves unless the table says plies
+    if ((wdl == WDL_WIN && !(d->flags & FLAG_WIN_PLIES)) || (wdl == WDL_LOSS && !(d->flags & FLAG_LOSS_PLIES)) ||
+        wdl == WDL_CURSED_WIN || wdl == WDL_BLESSED_LOSS)
+    {
+        value *= 2;
+    }
+    return value + 1;
+}
+
+// ********
+// indexing
+// ********
+
+static void sortSquares(int *squares, int count, bool byPawnMap)
+{
+    for (int i = 1; i < count; i++)
+    {
+        int s = squares[i];
+        int key = byPawnMap ? mapPawns[s] : s;
+        int j = i - 1;
+        while (j >= 0 && (byPawnMap ? mapPawns[squares[j]] : squares[j]) > key)
+        {
+            squares[j + 1] = squares[j];
+            j--;
+        }
+        squares[j + 1] = s;
+    }
+}
+
+static int probeTable(game position, tbTable *table, int wdl, int *result)
+{
+    int squares[TB_PIECES] = {0};
+    int pieces[TB_PIECES];
+    int size = 0;
+    int leadPawnsCount = 0;
+    int tbFile = 0;
+    uint64_t idx;
+    bitboard b;
+    bitboard leadPawns = 0;
+    bool blackToMove = !(position.metadata & WHITE_TO_MOVE);
+
+    // tables are stored with the stronger side as white, and symmetric ones
+    // with white to move only, anything else is flipped on the fly
+    bool symmetricBlackToMove = table->key == table->key2 && blackToMove;
+    bool blackStronger = positionKey(position.board) != table->key;
+    bool flip = symmetricBlackToMove || blackStronger;
+    int flipColour = flip ? 8 : 0;
+    int flipSquares = flip ? 56 : 0;
+    int stm = flip ^ blackToMove;
+
+    // pawn tables are split by the file of the leading pawn
+    if (table->hasPawns)
+    {
+        int leadPiece = getPairs(table, 0, 0)->pieces[0] ^ flipColour;
+        bitboard colour = leadPiece & 8 ? ~position.board.white : position.board.white;
+        leadPawns = b = position.board.pawn & colour;
+        while (b)
+        {
+            squares[size++] = popLsb(&b) ^ flipSquares;
+        }
+        leadPawnsCount = size;
+        int lead = 0;
+        for (int i = 1; i < leadPawnsCount; i++)
+        {
+            if (mapPawns[squares[i]] > mapPawns[squares[lead]])
+            {
+                lead = i;
+            }
+        }
+        int swap = squares[0];
+        squares[0] = squares[lead];
+        squares[lead] = swap;
+        tbFile = squares[0] & 7;
+        if (tbFile > 3)
+        {
+            tbFile = 7 - tbFile;
+        }
+    }
+
+    if (table->type == TB_DTZ)
+    {
+        int flags = getPairs(table, stm, tbFile)->flags;
+        if ((flags & FLAG_STM) != stm && !(table->key == table->key2 && !table->hasPawns))
+        {
+            *result = PROBE_CHANGE_STM;
+            return 0;
+        }
+    }
+
+    b = getPieces(position.board) ^ leadPawns;
+    while (b)
+    {
+        int s = popLsb(&b);
+        squares[size] = s ^ flipSquares;
+        pieces[size++] = pieceOn(position.board, s) ^ flipColour;
+    }
+
+    // reorder the pieces into the sequence the table was built with
+    pairsData *d = getPairs(table, stm, tbFile);
+    for (int i = leadPawnsCount; i < size - 1; i++)
+    {
+        for (int j = i + 1; j < size; j++)
+        {
+            if (d->pieces[i] == pieces[j])
+            {
+                int swap = pieces[i];
+                pieces[i] = pieces[j];
+                pieces[j] = swap;
+                swap = squares[i];
+                squares[i] = squares[j];
+                squares[j] = swap;
+                break;
+            }
+        }
+    }
+
+    // mirror the leading piece onto files a-d
+    if ((squares[0] & 7) > 3)
+    {
+        for (int i = 0; i < size; i++)
+        {
+            squares[i] ^= 7;
+        }
+    }
+
+    if (table->hasPawns)
+    {
+        idx = leadPawnIdx[leadPawnsCount][squares[0]];
+        sortSquares(squares + 1, leadPawnsCount - 1, true);
+        for (int i = 1; i < leadPawnsCount; i++)
+        {
+            idx += binomial[i][mapPawns[squares[i]]];
+        }
+    }
+    else
+    {
+        // without pawns also mirror onto ranks 1-4 and below the a1-h8 diagonal
+        if ((squares[0] >> 3) > 3)
+        {
+            for (int i = 0; i < size; i++)
+            {
+                squares[i] ^= 56;
+            }
+        }
+        for (int i = 0; i < d->groupLen[0]; i++)
+        {
+            if (!offA1H8(squares[i]))
+            {
+                continue;
+            }
+            if (offA1H8(squares[i]) > 0)
+            {
+                for (int j = i; j < size; j++)
+                {
+                    squares[j] = ((squares[j] >> 3) | (squares[j] << 3)) & 63;
+                }
+            }
+            break;
+        }
+
+        if (table->hasUniquePieces)
+        {
+            int adjust1 = squares[1] > squares[0];
+            int adjust2 = (squares[2] > squares[0]) + (squares[2] > squares[1]);
+            if (offA1H8(squares[0]))
+            {
+                idx = (mapA1D1D4[squares[0]] * 63 + (squares[1] - adjust1)) * 62 + squares[2] - adjust2;
+            }
+            else if (offA1H8(squares[1]))
+            {
+                idx = (6 * 63 + (squares[0] >> 3) * 28 + mapB1H1H7[squares[1]]) * 62 + squares[2] - adjust2;
+            }
+            else if (offA1H8(squares[2]))
+            {
+                idx = 6 * 63 * 62 + 4 * 28 * 62 + (squares[0] >> 3) * 7 * 28 + ((squares[1] >> 3) - adjust1) * 28 +
+                      mapB1H1H7[squares[2]];
+            }
+            else
+            {
+                idx = 6 * 63 * 62 + 4 * 28 * 62 + 4 * 7 * 28 + (squares[0] >> 3) * 7 * 6 +
+                      ((squares[1] >> 3) - adjust1) * 6 + ((squares[2] >> 3) - adjust2);
+            }
+        }
+        else
+        {
+            idx = mapKK[mapA1D1D4[squares[0]]][squares[1]];
+        }
+    }
+
+    // the remaining groups, each piece's square lowered by the occupied
+    // squares of earlier groups before below it
+    idx *= d->groupIdx[0];
+    int *groupSquares = squares + d->groupLen[0];
+    bool remainingPawns = table->hasPawns && table->pawnCount[1];
+    for (int next = 1; d->groupLen[next]; next++)
+    {
+        sortSquares(groupSquares, d->groupLen[next], false);
+        uint64_t n = 0;
+        for (int i = 0; i < d->groupLen[next]; i++)
+        {
+            int adjust = 0;
+            for (int *s = squares; s < groupSquares; s++)
+            {
+                adjust += groupSquares[i] > *s;
+            }
+            n += binomial[i + 1][groupSquares[i] - adjust - 8 * remainingPawns];
+        }
+        remainingPawns = false;
+        idx += n * d->groupIdx[next];
+        groupSquares += d->groupLen[next];
+    }
+
+    return mapScore(table, tbFile, decompressPairs(d, idx), wdl, result);
+}
+
+static int probeFile(game position, int type, int *result, int wdl)
+{
+    if (numSignificantBits(getPieces(position.board)) == 2)
+    {
+        return 0; // bare kings
+    }
+    int index = findTable(positionKey(position.board));
+    if (index < 0)
+    {
+        *result = PROBE_FAIL;
+        return 0;
+    }
+    tbTable *table = type == TB_WDL ? &wdlTables[index] : &dtzTables[index];
+    if (!mapTable(table))
+    {
+        *result = PROBE_FAIL;
+        return 0;
+    }
+    return probeTable(position, table, wdl, result);
+}
+
+// *******
+// probing
+// *******
+
+// tables hold "don't care" values where a capture (or for DTZ a pawn move)
+// is at least as good, so those moves are searched and the table probed only
+// for what is left. the best of both is the real result
+static int searchZeroing(game position, int *result, bool includePawnMoves)
+{
+    int value;
+    int bestValue = WDL_LOSS;
+    int moveCount = 0;
+    int totalCount = 0;
+    move *moves = getValidMoves(position);
+    for (int i = 0; moves[i].original != -1; i++)
+    {
+        totalCount++;
+        if (!isCapture(position.board, moves[i]) && (!includePawnMoves || !isPawnMove(position.board, moves[i])))
+        {
+            continue;
+        }
+        moveCount++;
+        game child = position;
+        executeMove(&child, moves[i]);
+        value = -searchZeroing(child, result, false);
+        if (*result == PROBE_FAIL)
+        {
+            free(moves);
+            return WDL_DRAW;
+        }
+        if (value > bestValue)
+        {
+            bestValue = value;
+            if (value >= WDL_WIN)
+            {
+                free(moves);
+                *result = PROBE_ZEROING_BEST_MOVE;
+                return value;
+            }
+        }
+    }
+    free(moves);
+
+    // with only zeroing moves available the table value can't be trusted
+    bool noMoreMoves = moveCount && moveCount == totalCount;
+    if (noMoreMoves)
+    {
+        value = bestValue;
+    }
+    else
+    {
+        value = probeFile(position, TB_WDL, result, WDL_DRAW);
+        if (*result == PROBE_FAIL)
+        {
+            return WDL_DRAW;
+        }
+    }
+
+    if (bestValue >= value)
+    {
+        *result = bestValue > WDL_DRAW || noMoreMoves ? PROBE_ZEROING_BEST_MOVE : PROBE_OK;
+        return bestValue;
+    }
+    *result = PROBE_OK;
+    return value;
+}
+
+static bool canProbe(game position)
+{
+    return largest > 0 && !(position.metadata & CASTLE_ALL) && numSignificantBits(getPieces(position.board)) <= largest;
+}
+
+int tbProbeWdl(game position, bool *success)
+{
+    if (!canProbe(position))
+    {
+        *success = false;
+        return WDL_DRAW;
+    }
+    int result = PROBE_OK;
+    int wdl = searchZeroing(position, &result, false);
+    *success = result != PROBE_FAIL;
+    return wdl;
+}
+
+// the DTZ just before a zeroing move that leads to the given result
+static int dtzBeforeZeroing(int wdl)
+{
+    switch (wdl)
+    {
+    case WDL_WIN:
+        return 1;
+    case WDL_CURSED_WIN:
+        return 101;
+    case WDL_BLESSED_LOSS:
+        return -101;
+    case WDL_LOSS:
+        return -1;
+    default:
+        return 0;
+    }
+}
+
+static int signOf(int value)
+{
+    return (value > 0) - (value < 0);
+}
+
+static int probeDtz(game position, int *result)
+{
+    *result = PROBE_OK;
+    int wdl = searchZeroing(position, result, true);
+    if (*result == PROBE_FAIL || wdl == WDL_DRAW)
+    {
+        return 0;
+    }
+    if (*result == PROBE_ZEROING_BEST_MOVE)
+    {
+        return dtzBeforeZeroing(wdl);
+    }
+
+    int dtz = probeFile(position, TB_DTZ, result, wdl);
+    if (*result == PROBE_FAIL)
+    {
+        return 0;
+    }
+    if (*result != PROBE_CHANGE_STM)
+    {
+        return (dtz + 100 * (wdl == WDL_BLESSED_LOSS || wdl == WDL_CURSED_WIN)) * signOf(wdl);
+    }
+
+    // the table only holds the other side to move, look one ply ahead
+    int minDtz = 0xFFFF;
+    move *moves = getValidMoves(position);
+    for (int i = 0; moves[i].original != -1; i++)
+    {
+        bool zeroing = isCapture(position.board, moves[i]) || isPawnMove(position.board, moves[i]);
+        game child = position;
+        executeMove(&child, moves[i]);
+
+        // for zeroing moves the DTZ before the move is what counts
+        dtz = zeroing ? -dtzBeforeZeroing(searchZeroing(child, result, false)) : -probeDtz(child, result);
+
+        // a mating move is always the fastest
+        if (dtz == 1 && inCheck(child) && getNumValidMoves(child) == 0)
+        {
+            minDtz = 1;
+        }
+        if (!zeroing)
+        {
+            dtz += signOf(dtz);
+        }
+        if (dtz < minDtz && signOf(dtz) == signOf(wdl))
+        {
+            minDtz = dtz;
+        }
+        if (*result == PROBE_FAIL)
+        {
+            free(moves);
+            return 0;
+        }
+    }
+    free(moves);
+    return minDtz == 0xFFFF ? -1 : minDtz;
+}
+
+int tbProbeDtz(game position, bool *success)
+{
+    if (!canProbe(position))
+    {
+        *success = false;
+        return 0;
+    }
+    int result;
+    int dtz = probeDtz(position, &result);
+    *success = result != PROBE_FAIL;
+    return dtz;
+}
+
+// ************
+// root filters
+// ************
+
+// certain wins rank equally, as do losses, unless the fifty move rule comes
+// into reach. without repetition tracking a repeated root is not detected
+static bool rankByDtz(game position, move *moves, int count, int *ranks)
+{
+    int halfmoves = position.halfmove_clock;
+    for (int i = 0; i < count; i++)
+    {
+        int result = PROBE_OK;
+        int dtz;
+        game child = position;
+        executeMove(&child, moves[i]);
+        if (child.halfmove_clock == 0)
+        {
+            dtz = dtzBeforeZeroing(-searchZeroing(child, &result, false));
+        }
+        else if (child.halfmove_clock >= 100)
+        {
+            dtz = 0;
+        }
+        else
+        {
+            dtz = -probeDtz(child, &result);
+            dtz = dtz > 0 ? dtz + 1 : dtz < 0 ? dtz - 1 : dtz;
+        }
+        if (dtz == 2 && inCheck(child) && getNumValidMoves(child) == 0)
+        {
+            dtz = 1;
+        }
+        if (result == PROBE_FAIL)
+        {
+            return false;
+        }
+        ranks[i] = dtz > 0   ? (dtz + halfmoves <= 99 ? MAX_DTZ : MAX_DTZ - (dtz + halfmoves))
+                   : dtz < 0 ? (-dtz * 2 + halfmoves < 100 ? -MAX_DTZ : -MAX_DTZ + (-dtz + halfmoves))
+                             : 0;
+    }
+    return true;
+}
+
+static bool rankByWdl(game position, move *moves, int count, int *ranks)
+{
+    const int wdlToRank[] = {-MAX_DTZ, -MAX_DTZ + 101, 0, MAX_DTZ - 101, MAX_DTZ};
+    for (int i = 0; i < count; i++)
+    {
+        int result = PROBE_OK;
+        game child = position;
+        executeMove(&child, moves[i]);
+        int wdl = -searchZeroing(child, &result, false);
+        if (result == PROBE_FAIL)
+        {
+            return false;
+        }
+        ranks[i] = wdlToRank[wdl + 2];
+    }
+    return true;
+}
+
+int tbFilterRootMoves(game position, move *moves, int count)
+{
+    int ranks[MAX_MOVES];
+    if (count == 0 || count > MAX_MOVES || !canProbe(position))
+    {
+        return count;
+    }
+    if (!rankByDtz(position, moves, count, ranks) && !rankByWdl(position, moves, count, ranks))
+    {
+        return count;
+    }
+
+    int best = ranks[0];
+    for (int i = 1; i < count; i++)
+    {
+        if (ranks[i] > best)
+        {
+            best = ranks[i];
+        }
+    }
+    int kept = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (ranks[i] == best)
+        {
+            moves[kept++] = moves[i];
+        }
+    }
+    return kept;
+}
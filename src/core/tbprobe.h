@@ -0,0 +1,43 @@
+#ifndef MEOWL_TBPROBE_H
+#define MEOWL_TBPROBE_H
+
+#include "bitboards.h"
+
+// the implementation in tbprobe.c is derived from Stockfish and licensed under
+// the GPL version 3 or later, see its header. binaries linking it fall under
+// the GPL too
+
+// win/draw/loss from the side to move's point of view. cursed wins and
+// blessed losses are results that the fifty move rule turns into draws
+#define WDL_LOSS -2
+#define WDL_BLESSED_LOSS -1
+#define WDL_DRAW 0
+#define WDL_CURSED_WIN 1
+#define WDL_WIN 2
+
+// looks for Syzygy .rtbw/.rtbz files (up to 6 pieces) in a ':' separated list of
+// directories. files are only checked for existence here and memory mapped on
+// first probe. not thread safe, call while no search is running. returns the
+// number of tables found
+int tbInit(const char *paths);
+void tbFree(void);
+
+// most pieces covered by the tables found, 0 if there are none
+int tbLargest(void);
+
+// the probes below are thread safe. they only succeed for positions without
+// castling rights and with at most tbLargest() pieces
+
+// win/draw/loss of the position
+int tbProbeWdl(game position, bool *success);
+
+// distance to zeroing (capture or pawn move) in plies, signed by the result:
+// > 0 win, < 0 loss, 0 draw. see the Syzygy notes in tbprobe.c for the fifty move details
+int tbProbeDtz(game position, bool *success);
+
+// keeps only the root moves that hold on to the best tablebase result, ranked
+// by DTZ (or by WDL when DTZ tables are missing). returns the new number of
+// moves, or count unchanged if the position could not be probed
+int tbFilterRootMoves(game position, move *moves, int count);
+
+#endif
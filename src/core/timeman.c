@@ -0,0 +1,45 @@
+#include "timeman.h"
+
+// moves assumed to be left in sudden death games
+#define DEFAULT_MOVES_TO_GO 25
+
+void allocateTime(searchLimits *limits, int64_t remaining, int64_t increment, int movestogo, int64_t overhead)
+{
+    int64_t available = remaining - overhead;
+    if (available < 1)
+    {
+        available = 1;
+    }
+    int movesLeft = movestogo > 0 && movestogo < DEFAULT_MOVES_TO_GO ? movestogo : DEFAULT_MOVES_TO_GO;
+
+    // an even share of the clock plus most of the increment. the hard limit
+    // allows the search to overrun that for unstable positions but never
+    // spends more than half of the clock, or most of it on the last move
+    // before a time control
+    int64_t soft = available / movesLeft + increment * 3 / 4;
+    int64_t hard = soft * 3;
+    int64_t maximum = movestogo == 1 ? available * 9 / 10 : available / 2;
+    if (hard > maximum)
+    {
+        hard = maximum;
+    }
+    if (soft > hard)
+    {
+        soft = hard;
+    }
+    limits->softTime = soft > 0 ? soft : 1;
+    limits->time = hard > 0 ? hard : 1;
+}
+
+int softTimeScale(int stableIterations, int scoreDrop)
+{
+    // a best move that keeps changing needs more time, one that has held
+    // for several iterations is unlikely to change in the next one
+    static const int stability[] = {150, 120, 100, 85, 70};
+    int scale = stability[stableIterations < 4 ? stableIterations : 4];
+    if (scoreDrop > 0)
+    {
+        scale += (scoreDrop < 100 ? scoreDrop : 100) / 2;
+    }
+    return scale;
+}
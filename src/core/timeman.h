@@ -0,0 +1,15 @@
+#ifndef MEOWL_TIMEMAN_H
+#define MEOWL_TIMEMAN_H
+
+#include "search.h"
+
+// sets the soft and hard limits for one move from the clock (all in ms).
+// movestogo 0 means sudden death, overhead is kept back for communication lag
+void allocateTime(searchLimits *limits, int64_t remaining, int64_t increment, int movestogo, int64_t overhead);
+
+// percentage of the soft limit to use after an iteration. stableIterations
+// counts the iterations since the best move last changed, scoreDrop is how
+// many centipawns the score fell since the previous iteration
+int softTimeScale(int stableIterations, int scoreDrop);
+
+#endif
@@ -0,0 +1,98 @@
+// evaluation weights, generated by src/tools/tune.c (make build_tune). edit by
+// hand only to change the starting point of the next tuning run
+#ifndef MEOWL_WEIGHTS_H
+#define MEOWL_WEIGHTS_H
+
+#define PAWN_VALUE 100
+#define KNIGHT_VALUE 320
+#define BISHOP_VALUE 330
+#define ROOK_VALUE 500
+#define QUEEN_VALUE 900
+
+// material imbalance: a bishop pair, and per knight or rook for each own pawn above 5
+#define BISHOP_PAIR 30
+#define KNIGHT_PAWNS 4
+#define ROOK_PAWNS -6
+
+// pawn structure, per pawn. passed pawns by rank from their own side, rank 1 first
+#define DOUBLED_PAWN -10
+#define ISOLATED_PAWN -12
+#define PASSED_PAWN_TABLE {0, 5, 10, 20, 35, 60, 100, 0}
+
+// mobility, per attacked square not taken by an own piece
+#define MOBILITY 2
+
+// piece-square bonuses as seen from white's side, rank 8 first
+#define PAWN_TABLE \
+    { \
+        0, 0, 0, 0, 0, 0, 0, 0, \
+        50, 50, 50, 50, 50, 50, 50, 50, \
+        10, 10, 20, 30, 30, 20, 10, 10, \
+        5, 5, 10, 25, 25, 10, 5, 5, \
+        0, 0, 0, 20, 20, 0, 0, 0, \
+        5, -5, -10, 0, 0, -10, -5, 5, \
+        5, 10, 10, -20, -20, 10, 10, 5, \
+        0, 0, 0, 0, 0, 0, 0, 0 \
+    }
+
+#define KNIGHT_TABLE \
+    { \
+        -50, -40, -30, -30, -30, -30, -40, -50, \
+        -40, -20, 0, 0, 0, 0, -20, -40, \
+        -30, 0, 10, 15, 15, 10, 0, -30, \
+        -30, 5, 15, 20, 20, 15, 5, -30, \
+        -30, 0, 15, 20, 20, 15, 0, -30, \
+        -30, 5, 10, 15, 15, 10, 5, -30, \
+        -40, -20, 0, 5, 5, 0, -20, -40, \
+        -50, -40, -30, -30, -30, -30, -40, -50 \
+    }
+
+#define BISHOP_TABLE \
+    { \
+        -20, -10, -10, -10, -10, -10, -10, -20, \
+        -10, 0, 0, 0, 0, 0, 0, -10, \
+        -10, 0, 5, 10, 10, 5, 0, -10, \
+        -10, 5, 5, 10, 10, 5, 5, -10, \
+        -10, 0, 10, 10, 10, 10, 0, -10, \
+        -10, 10, 10, 10, 10, 10, 10, -10, \
+        -10, 5, 0, 0, 0, 0, 5, -10, \
+        -20, -10, -10, -10, -10, -10, -10, -20 \
+    }
+
+#define ROOK_TABLE \
+    { \
+        0, 0, 0, 0, 0, 0, 0, 0, \
+        5, 10, 10, 10, 10, 10, 10, 5, \
+        -5, 0, 0, 0, 0, 0, 0, -5, \
+        -5, 0, 0, 0, 0, 0, 0, -5, \
+        -5, 0, 0, 0, 0, 0, 0, -5, \
+        -5, 0, 0, 0, 0, 0, 0, -5, \
+        -5, 0, 0, 0, 0, 0, 0, -5, \
+        0, 0, 0, 5, 5, 0, 0, 0 \
+    }
+
+#define QUEEN_TABLE \
+    { \
+        -20, -10, -10, -5, -5, -10, -10, -20, \
+        -10, 0, 0, 0, 0, 0, 0, -10, \
+        -10, 0, 5, 5, 5, 5, 0, -10, \
+        -5, 0, 5, 5, 5, 5, 0, -5, \
+        0, 0, 5, 5, 5, 5, 0, -5, \
+        -10, 5, 5, 5, 5, 5, 0, -10, \
+        -10, 0, 5, 0, 0, 0, 0, -10, \
+        -20, -10, -10, -5, -5, -10, -10, -20 \
+    }
+
+#define KING_TABLE \
+    { \
+        -30, -40, -40, -50, -50, -40, -40, -30, \
+        -30, -40, -40, -50, -50, -40, -40, -30, \
+        -30, -40, -40, -50, -50, -40, -40, -30, \
+        -30, -40, -40, -50, -50, -40, -40, -30, \
+        -20, -30, -30, -40, -40, -30, -30, -20, \
+        -10, -20, -20, -20, -20, -20, -20, -10, \
+        20, 20, 0, 0, 0, 0, 20, 20, \
+        20, 30, 10, 0, 0, 10, 30, 20 \
+    }
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef MEOWL_ZOBRIST_H
+#define MEOWL_ZOBRIST_H
+
+#include <stdint.h>
+#include "bitboards.h"
+
+// Polyglot key layout: 12 * 64 piece-square entries, 4 castling, 8 en passant files, 1 side to move
+#define POLYGLOT_RANDOM_COUNT 781
+#define POLYGLOT_CASTLE 768
+#define POLYGLOT_EN_PASSANT 772
+#define POLYGLOT_TURN 780
+
+extern const uint64_t polyglotRandom[POLYGLOT_RANDOM_COUNT];
+
+// Polyglot-style hash of the position, used as the opening book key
+uint64_t getPositionKey(game game);
+
+#endif
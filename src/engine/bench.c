@@ -0,0 +1,270 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "search.h"
+#include "fen.h"
+#include "positions.h"
+#include "packed.h"
+#include "zobrist.h"
+#include "tbprobe.h"
+#include "egtb.h"
+
+uint64_t runBench(int depth)
+{
+    int count = BENCH_POSITION_COUNT;
+    uint64_t totalNodes = 0;
+    int64_t totalTime = 0;
+    searchLimits limits = (searchLimits){.depth = depth};
+    char text[6];
+
+    for (int i = 0; i < count; i++)
+    {
+        game game;
+        if (parseFen(&game, benchPositions[i]) == NULL)
+        {
+            fprintf(stderr, "bench: bad fen %s\n", benchPositions[i]);
+            continue;
+        }
+
+        searchInfo result;
+        move best = search(game, limits, NULL, NULL, NULL, &result);
+        totalNodes += result.nodes;
+        totalTime += result.time;
+
+        moveToString(best, text);
+        fprintf(stderr, "Position %d/%d: %-6s %10llu nodes  %s\n", i + 1, count, best.original != -1 ? text : "none",
+                (unsigned long long)result.nodes, benchPositions[i]);
+    }
+
+    if (totalTime <= 0)
+    {
+        totalTime = 1;
+    }
+    fprintf(stderr, "===========================\n");
+    fprintf(stderr, "Depth           : %d\n", depth);
+    fprintf(stderr, "Total time (ms) : %lld\n", (long long)totalTime);
+    fprintf(stderr, "Nodes searched  : %llu\n", (unsigned long long)totalNodes);
+    fprintf(stderr, "Nodes/second    : %llu\n", (unsigned long long)(totalNodes * 1000 / totalTime));
+    printf("%llu nodes %llu nps\n", (unsigned long long)totalNodes, (unsigned long long)(totalNodes * 1000 / totalTime));
+    fflush(stdout);
+    return totalNodes;
+}
+
+// ****************
+// packed positions
+// ****************
+
+#define PACK_BATCH 4096
+
+typedef struct
+{
+    game positions[PACK_BATCH];
+    packedPosition packed[PACK_BATCH];
+    game unpacked[PACK_BATCH];
+    int count;
+    uint64_t checked;
+    uint64_t failures;
+} packBatch;
+
+static bool sameGame(const game *a, const game *b)
+{
+    return memcmp(&a->board, &b->board, sizeof(board)) == 0 && a->metadata == b->metadata &&
+           a->en_passants == b->en_passants && a->halfmove_clock == b->halfmove_clock &&
+           a->fullmove_number == b->fullmove_number;
+}
+
+static void checkBatch(packBatch *batch)
+{
+    packPositions(batch->positions, batch->packed, batch->count);
+    unpackPositions(batch->packed, batch->unpacked, batch->count);
+    for (int i = 0; i < batch->count; i++)
+    {
+        game canonical = canonicalPosition(batch->positions[i]);
+        packedPosition repacked;
+        packPosition(batch->unpacked[i], &repacked);
+        // canonicalising may only drop state that has no effect on the moves
+        bool ok = sameGame(&canonical, &batch->unpacked[i]) &&
+                  memcmp(&repacked, &batch->packed[i], sizeof(packedPosition)) == 0 &&
+                  getNumValidMoves(canonical) == getNumValidMoves(batch->positions[i]);
+        if (!ok && batch->failures++ < 10)
+        {
+            char fen[FEN_MAX];
+            writeFen(batch->positions[i], fen);
+            fprintf(stderr, "packcheck: round trip failed for %s\n", fen);
+        }
+    }
+    batch->checked += batch->count;
+    batch->count = 0;
+}
+
+static void collectPositions(packBatch *batch, game position, int depth)
+{
+    batch->positions[batch->count++] = position;
+    if (batch->count == PACK_BATCH)
+    {
+        checkBatch(batch);
+    }
+    if (depth == 0)
+    {
+        return;
+    }
+    move *moves = getValidMoves(position);
+    for (int i = 0; moves[i].original != -1; i++)
+    {
+        game child = position;
+        executeMove(&child, moves[i]);
+        collectPositions(batch, child, depth - 1);
+    }
+    free(moves);
+}
+
+uint64_t runPackCheck(int depth)
+{
+    packBatch *batch = (packBatch *)malloc(sizeof(packBatch));
+    batch->count = 0;
+    batch->checked = 0;
+    batch->failures = 0;
+    int64_t start = getTimeMs();
+    for (int i = 0; i < BENCH_POSITION_COUNT; i++)
+    {
+        game game;
+        if (parseFen(&game, benchPositions[i]) != NULL)
+        {
+            collectPositions(batch, game, depth);
+        }
+    }
+    checkBatch(batch);
+    uint64_t failures = batch->failures;
+    fprintf(stderr, "===========================\n");
+    fprintf(stderr, "Depth           : %d\n", depth);
+    fprintf(stderr, "Total time (ms) : %lld\n", (long long)(getTimeMs() - start));
+    fprintf(stderr, "Positions       : %llu\n", (unsigned long long)batch->checked);
+    printf("%llu positions %llu failures\n", (unsigned long long)batch->checked, (unsigned long long)failures);
+    fflush(stdout);
+    free(batch);
+    return failures;
+}
+
+// positions after 1.e4, 1.e4 d5, ... as listed with the Random64 table
+static const struct
+{
+    const char *fen;
+    uint64_t key;
+} polyglotKeys[] = {
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 0x463B96181691FC9CULL},
+    {"rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1", 0x823C9B50FD114196ULL},
+    {"rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 2", 0x0756B94461C50FB0ULL},
+    {"rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR b KQkq - 0 2", 0x662FAFB965DB29D4ULL},
+    {"rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3", 0x22A48B5A8E47FF78ULL},
+    {"rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR b kq - 0 3", 0x652A607CA3F242C1ULL},
+    {"rnbq1bnr/ppp1pkpp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR w - - 0 4", 0x00FDD303C946BDD9ULL},
+    {"rnbqkbnr/p1pppppp/8/8/PpP4P/8/1P1PPPP1/RNBQKBNR b KQkq c3 0 3", 0x3C8123EA7B067637ULL},
+    {"rnbqkbnr/p1pppppp/8/8/P6P/R1p5/1P1PPPP1/1NBQKBNR b Kkq - 0 4", 0x5C3F9B829B279560ULL},
+};
+
+int runKeyCheck(void)
+{
+    int count = sizeof(polyglotKeys) / sizeof(polyglotKeys[0]);
+    int failures = 0;
+    for (int i = 0; i < count; i++)
+    {
+        game game;
+        uint64_t key = parseFen(&game, polyglotKeys[i].fen) != NULL ? getPositionKey(game) : 0;
+        if (key != polyglotKeys[i].key)
+        {
+            fprintf(stderr, "keycheck: %016llX instead of %016llX for %s\n", (unsigned long long)key,
+                    (unsigned long long)polyglotKeys[i].key, polyglotKeys[i].fen);
+            failures++;
+        }
+    }
+    printf("%d positions %d failures\n", count, failures);
+    fflush(stdout);
+    return failures;
+}
+
+// **********************
+// tablebase cross-checks
+// **********************
+
+// white's extra piece in each of the checked endgames
+static const struct
+{
+    const char *name;
+    bool queen;
+} tbCheckEndgames[] = {{"KQK", true}, {"KRK", false}};
+
+// win/draw/loss of a value from Meowl's own tables, in the Syzygy scale
+static int egtbWdl(int value)
+{
+    return EGTB_IS_WIN(value) ? WDL_WIN : EGTB_IS_LOSS(value) ? WDL_LOSS : WDL_DRAW;
+}
+
+int runTbCheck(const char *syzygyPaths, const char *egtbDirectory)
+{
+    if (tbInit(syzygyPaths) == 0 || egtbInit(egtbDirectory) == 0)
+    {
+        fprintf(stderr, "tbcheck: needs KQvK and KRvK Syzygy tables and KQK and KRK tables from tbgen\n");
+        return -1;
+    }
+    game start;
+    parseFen(&start, "4k3/8/8/8/8/8/8/4K3 w - - 0 1");
+    int checked = 0;
+    int failures = 0;
+    for (int e = 0; e < (int)(sizeof(tbCheckEndgames) / sizeof(tbCheckEndgames[0])); e++)
+    {
+        for (int i = 0; i < 64 * 64 * 64 * 2; i++)
+        {
+            int whiteKing = i % 64;
+            int blackKing = i / 64 % 64;
+            int piece = i / (64 * 64) % 64;
+            if (whiteKing == blackKing || piece == whiteKing || piece == blackKing)
+            {
+                continue;
+            }
+            game position = start;
+            position.board = (board){0};
+            position.board.king = 1ULL << whiteKing | 1ULL << blackKing;
+            position.board.white = 1ULL << whiteKing | 1ULL << piece;
+            if (tbCheckEndgames[e].queen)
+            {
+                position.board.queen = 1ULL << piece;
+            }
+            else
+            {
+                position.board.rook = 1ULL << piece;
+            }
+            position.metadata = i < 64 * 64 * 64 ? WHITE_TO_MOVE : 0;
+            // the side that just moved cannot be left in check
+            position.metadata ^= WHITE_TO_MOVE;
+            bool illegal = inCheck(position);
+            position.metadata ^= WHITE_TO_MOVE;
+            if (illegal)
+            {
+                continue;
+            }
+
+            bool found;
+            bool success;
+            int expected = egtbWdl(egtbProbe(position, &found));
+            int wdl = tbProbeWdl(position, &success);
+            int dtz = success ? tbProbeDtz(position, &success) : 0;
+            checked++;
+            if (!found || !success || wdl != expected || (dtz > 0) != (wdl > 0) || (dtz < 0) != (wdl < 0))
+            {
+                if (failures < 10)
+                {
+                    fprintf(stderr, "tbcheck: %s wdl %d dtz %d instead of wdl %d, %s to move, kings %d %d piece %d\n",
+                            tbCheckEndgames[e].name, wdl, dtz, expected,
+                            position.metadata & WHITE_TO_MOVE ? "white" : "black", whiteKing, blackKing, piece);
+                }
+                failures++;
+            }
+        }
+    }
+    tbFree();
+    egtbFree();
+    printf("%d positions %d failures\n", checked, failures);
+    fflush(stdout);
+    return failures;
+}
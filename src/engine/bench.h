@@ -0,0 +1,27 @@
+#ifndef MEOWL_BENCH_H
+#define MEOWL_BENCH_H
+
+#include <stdint.h>
+
+#define BENCH_DEPTH 3
+
+// searches the built-in positions to a fixed depth on one thread and prints the
+// total node count (a signature of search behaviour) and nodes per second
+uint64_t runBench(int depth);
+
+#define PACKCHECK_DEPTH 2
+
+// packs every position of the perft trees below the built-in positions, unpacks
+// them again and checks the round trip. returns the number of failures
+uint64_t runPackCheck(int depth);
+
+// compares getPositionKey with the keys of the test positions in Polyglot's
+// book format description. returns the number of mismatches
+int runKeyCheck(void);
+
+// compares the Syzygy KQvK and KRvK tables with the KQK and KRK tables tbgen
+// builds, win/draw/loss and the sign of DTZ for every legal position. returns
+// the number of mismatches, -1 if the tables are missing
+int runTbCheck(const char *syzygyPaths, const char *egtbDirectory);
+
+#endif
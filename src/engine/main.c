@@ -0,0 +1,38 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bitboards.h"
+#include "uci.h"
+#include "bench.h"
+
+// ****************
+// headless program
+// ****************
+
+int main(int argc, char **argv)
+{
+    // "meowl bench [depth]" runs the benchmark and exits, for build scripts
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        runBench(argc > 2 ? atoi(argv[2]) : BENCH_DEPTH);
+        return 0;
+    }
+    // "meowl packcheck [depth]" checks the packed position encoding and exits
+    if (argc > 1 && strcmp(argv[1], "packcheck") == 0)
+    {
+        return runPackCheck(argc > 2 ? atoi(argv[2]) : PACKCHECK_DEPTH) == 0 ? 0 : 1;
+    }
+    // "meowl keycheck" checks the book keys against Polyglot's test positions
+    if (argc > 1 && strcmp(argv[1], "keycheck") == 0)
+    {
+        return runKeyCheck() == 0 ? 0 : 1;
+    }
+    // "meowl tbcheck syzygy-paths table-directory" checks the Syzygy probing
+    // against the tables from tbgen
+    if (argc > 3 && strcmp(argv[1], "tbcheck") == 0)
+    {
+        return runTbCheck(argv[2], argv[3]) == 0 ? 0 : 1;
+    }
+
+    return uciLoop();
+}
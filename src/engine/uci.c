@@ -0,0 +1,424 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdarg.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "uci.h"
+#include "search.h"
+#include "timeman.h"
+#include "fen.h"
+#include "bench.h"
+#include "book.h"
+#include "tbprobe.h"
+#include "egtb.h"
+
+#define INPUT_BUFFER 65536
+
+static game position;
+static pthread_t searchThread;
+static bool searching = false;
+static atomic_bool stopSearch;
+static searchLimits goLimits;
+static bool goInfinite = false;
+static int moveOverhead = 10;
+static openingBook book;
+static bool ownBook = false;
+static pthread_mutex_t outputLock = PTHREAD_MUTEX_INITIALIZER;
+
+// ******
+// output
+// ******
+
+// the search thread and the input thread both write to stdout
+static void sendLine(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    pthread_mutex_lock(&outputLock);
+    vprintf(format, args);
+    printf("\n");
+    fflush(stdout);
+    pthread_mutex_unlock(&outputLock);
+    va_end(args);
+}
+
+static void printInfo(const searchInfo *info, void *data)
+{
+    (void)data;
+    char pv[MAX_PLY * 6 + 1] = "";
+    char text[6];
+    for (int i = 0; i < info->pvLength; i++)
+    {
+        moveToString(info->pv[i], text);
+        strcat(pv, " ");
+        strcat(pv, text);
+    }
+
+    char score[32];
+    if (info->score >= MATE_BOUND || info->score <= -MATE_BOUND)
+    {
+        int plies = MATE_SCORE - abs(info->score);
+        snprintf(score, sizeof(score), "mate %d", info->score > 0 ? (plies + 1) / 2 : -(plies / 2));
+    }
+    else
+    {
+        snprintf(score, sizeof(score), "cp %d", info->score);
+    }
+
+    int64_t time = info->time > 0 ? info->time : 1;
+    sendLine("info depth %d score %s nodes %llu nps %llu tbhits %llu time %lld pv%s", info->depth, score,
+             (unsigned long long)info->nodes, (unsigned long long)(info->nodes * 1000 / time),
+             (unsigned long long)info->tbHits, (long long)info->time, pv);
+}
+
+// ******
+// search
+// ******
+
+static void *searchWorker(void *unused)
+{
+    (void)unused;
+    move best = search(position, goLimits, &stopSearch, printInfo, NULL, NULL);
+
+    // "go infinite" may only answer once the gui has sent stop
+    while (goInfinite && !atomic_load(&stopSearch))
+    {
+        usleep(1000);
+    }
+
+    char text[6] = "0000";
+    if (best.original != -1)
+    {
+        moveToString(best, text);
+    }
+    sendLine("bestmove %s", text);
+    return NULL;
+}
+
+static void stopSearching(void)
+{
+    if (searching)
+    {
+        atomic_store(&stopSearch, true);
+        pthread_join(searchThread, NULL);
+        searching = false;
+    }
+}
+
+// *****************
+// command handling
+// *****************
+
+static move parseMove(game game, const char *text)
+{
+    move *moves = getValidMoves(game);
+    move found = (move){-1, -1, 0};
+    char candidate[6];
+    for (int i = 0; moves[i].original != -1; i++)
+    {
+        moveToString(moves[i], candidate);
+        if (strcmp(candidate, text) == 0)
+        {
+            found = moves[i];
+            break;
+        }
+    }
+    free(moves);
+    return found;
+}
+
+static void handlePosition(char *args)
+{
+    char *moveList = strstr(args, "moves");
+    if (moveList != NULL)
+    {
+        moveList[-1] = 0;
+        moveList += 5;
+    }
+
+    if (strncmp(args, "startpos", 8) == 0)
+    {
+        position = newGame();
+    }
+    else if (strncmp(args, "fen ", 4) == 0)
+    {
+        if (parseFen(&position, args + 4) == NULL)
+        {
+            sendLine("info string invalid fen %s", args + 4);
+            return;
+        }
+    }
+    else
+    {
+        return;
+    }
+
+    if (moveList != NULL)
+    {
+        char *save = NULL;
+        char *token;
+        for (token = strtok_r(moveList, " ", &save); token != NULL; token = strtok_r(NULL, " ", &save))
+        {
+            move move = parseMove(position, token);
+            if (move.original == -1)
+            {
+                sendLine("info string illegal move %s", token);
+                return;
+            }
+            executeMove(&position, move);
+        }
+    }
+}
+
+static void handlePerft(int depth)
+{
+    int64_t start = getTimeMs();
+    move *moves = getValidMoves(position);
+    uint64_t total = 0;
+    char text[6];
+    for (int i = 0; moves[i].original != -1; i++)
+    {
+        game child = position;
+        executeMove(&child, moves[i]);
+        uint64_t nodes = perft(child, depth - 1);
+        moveToString(moves[i], text);
+        sendLine("%s: %llu", text, (unsigned long long)nodes);
+        total += nodes;
+    }
+    free(moves);
+    sendLine("\nNodes searched: %llu (%lld ms)", (unsigned long long)total, (long long)(getTimeMs() - start));
+}
+
+static void handleGo(char *args)
+{
+    searchLimits limits = {0};
+    int64_t wtime = -1, btime = -1, winc = 0, binc = 0, movetime = 0;
+    int movestogo = 0;
+    bool infinite = false;
+
+    char *save = NULL;
+    char *token = strtok_r(args, " ", &save);
+    while (token != NULL)
+    {
+        char *value = strtok_r(NULL, " ", &save);
+        if (strcmp(token, "infinite") == 0)
+        {
+            infinite = true;
+            token = value;
+            continue;
+        }
+        if (value == NULL)
+        {
+            break;
+        }
+        if (strcmp(token, "wtime") == 0)
+        {
+            wtime = atoll(value);
+        }
+        else if (strcmp(token, "btime") == 0)
+        {
+            btime = atoll(value);
+        }
+        else if (strcmp(token, "winc") == 0)
+        {
+            winc = atoll(value);
+        }
+        else if (strcmp(token, "binc") == 0)
+        {
+            binc = atoll(value);
+        }
+        else if (strcmp(token, "movestogo") == 0)
+        {
+            movestogo = atoi(value);
+        }
+        else if (strcmp(token, "movetime") == 0)
+        {
+            movetime = atoll(value);
+        }
+        else if (strcmp(token, "nodes") == 0)
+        {
+            limits.nodes = strtoull(value, NULL, 10);
+        }
+        else if (strcmp(token, "depth") == 0)
+        {
+            limits.depth = atoi(value);
+        }
+        else if (strcmp(token, "perft") == 0)
+        {
+            handlePerft(atoi(value));
+            return;
+        }
+        token = strtok_r(NULL, " ", &save);
+    }
+
+    bool isWhite = position.metadata & WHITE_TO_MOVE;
+    int64_t remaining = isWhite ? wtime : btime;
+    int64_t increment = isWhite ? winc : binc;
+    if (movetime > 0)
+    {
+        limits.time = movetime - moveOverhead > 0 ? movetime - moveOverhead : 1;
+    }
+    else if (remaining >= 0 && !infinite)
+    {
+        allocateTime(&limits, remaining, increment, movestogo, moveOverhead);
+    }
+    if (infinite)
+    {
+        limits = (searchLimits){0};
+    }
+
+    // book moves are played straight away, except when analysing
+    if (ownBook && !infinite)
+    {
+        move bookMove = probeBook(&book, position);
+        char text[6];
+        moveToString(bookMove, text);
+        if (bookMove.original != -1 && parseMove(position, text).original != -1)
+        {
+            sendLine("bestmove %s", text);
+            return;
+        }
+    }
+
+    goLimits = limits;
+    goInfinite = infinite;
+    atomic_store(&stopSearch, false);
+    searching = pthread_create(&searchThread, NULL, searchWorker, NULL) == 0;
+}
+
+static void handleSetOption(char *args)
+{
+    // setoption name <id> [value <x>], names may contain spaces
+    char *name = strstr(args, "name ");
+    if (name == NULL)
+    {
+        return;
+    }
+    name += 5;
+    char *value = strstr(name, " value ");
+    if (value != NULL)
+    {
+        *value = 0;
+        value += 7;
+    }
+
+    if (strcasecmp(name, "Move Overhead") == 0 && value != NULL)
+    {
+        moveOverhead = atoi(value);
+    }
+    else if (strcasecmp(name, "OwnBook") == 0 && value != NULL)
+    {
+        ownBook = strcasecmp(value, "true") == 0;
+    }
+    else if (strcasecmp(name, "BookFile") == 0 && value != NULL)
+    {
+        closeBook(&book);
+        if (!openBook(&book, value))
+        {
+            sendLine("info string could not open book %s", value);
+        }
+    }
+    else if (strcasecmp(name, "SyzygyPath") == 0 && value != NULL)
+    {
+        int found = tbInit(value);
+        sendLine("info string found %d tablebases, up to %d pieces", found, tbLargest());
+    }
+    else if (strcasecmp(name, "EgtbPath") == 0 && value != NULL)
+    {
+        int found = egtbInit(value);
+        sendLine("info string found %d endgame tables, up to %d pieces", found, egtbLargest());
+    }
+    else
+    {
+        sendLine("info string unknown option %s", name);
+    }
+}
+
+int uciLoop(void)
+{
+    char *line = (char *)malloc(INPUT_BUFFER);
+    position = newGame();
+    atomic_init(&stopSearch, false);
+
+    while (fgets(line, INPUT_BUFFER, stdin) != NULL)
+    {
+        line[strcspn(line, "\r\n")] = 0;
+        char *args = strchr(line, ' ');
+        if (args != NULL)
+        {
+            *args = 0;
+            args++;
+        }
+        else
+        {
+            args = line + strlen(line);
+        }
+
+        if (strcmp(line, "uci") == 0)
+        {
+            sendLine("id name Meowl");
+            sendLine("id author rikk1e");
+            sendLine("option name Move Overhead type spin default 10 min 0 max 5000");
+            sendLine("option name OwnBook type check default false");
+            sendLine("option name BookFile type string default <empty>");
+            sendLine("option name SyzygyPath type string default <empty>");
+            sendLine("option name EgtbPath type string default <empty>");
+            sendLine("uciok");
+        }
+        else if (strcmp(line, "isready") == 0)
+        {
+            sendLine("readyok");
+        }
+        else if (strcmp(line, "ucinewgame") == 0)
+        {
+            stopSearching();
+            position = newGame();
+        }
+        else if (strcmp(line, "position") == 0)
+        {
+            stopSearching();
+            handlePosition(args);
+        }
+        else if (strcmp(line, "go") == 0)
+        {
+            stopSearching();
+            handleGo(args);
+        }
+        else if (strcmp(line, "stop") == 0)
+        {
+            stopSearching();
+        }
+        else if (strcmp(line, "setoption") == 0)
+        {
+            stopSearching();
+            handleSetOption(args);
+        }
+        else if (strcmp(line, "d") == 0)
+        {
+            // printBoard writes without the output lock
+            stopSearching();
+            char fen[FEN_MAX];
+            writeFen(position, fen);
+            printBoard(position.board);
+            sendLine("Fen: %s", fen);
+        }
+        else if (strcmp(line, "bench") == 0)
+        {
+            stopSearching();
+            runBench(*args ? atoi(args) : BENCH_DEPTH);
+        }
+        else if (strcmp(line, "quit") == 0)
+        {
+            break;
+        }
+    }
+
+    stopSearching();
+    closeBook(&book);
+    tbFree();
+    egtbFree();
+    free(line);
+    return 0;
+}
@@ -0,0 +1,8 @@
+#ifndef MEOWL_UCI_H
+#define MEOWL_UCI_H
+
+// reads UCI commands from stdin until "quit", searching on a separate thread
+// so input (stop, isready) is always handled straight away
+int uciLoop(void);
+
+#endif
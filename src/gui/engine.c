@@ -0,0 +1,147 @@
+#include "engine.h"
+
+#define COMMAND_QUEUE_SIZE 8
+#define RESULT_QUEUE_SIZE 64
+
+// only the idle worker ever sleeps. it raises workerWaiting before looking at
+// the command queue a last time, and a push looks at the flag after it is
+// done, so with the fences in between at least one of them sees the other.
+// the render loop only takes the lock when the worker is actually asleep
+static void wakeWorker(engineThread *engine)
+{
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load(&engine->workerWaiting))
+    {
+        pthread_mutex_lock(&engine->lock);
+        pthread_cond_signal(&engine->wake);
+        pthread_mutex_unlock(&engine->lock);
+    }
+}
+
+static void nextCommand(engineThread *engine, engineCommand *command)
+{
+    if (queuePop(&engine->commands, command))
+    {
+        return;
+    }
+    pthread_mutex_lock(&engine->lock);
+    atomic_store(&engine->workerWaiting, true);
+    atomic_thread_fence(memory_order_seq_cst);
+    while (!queuePop(&engine->commands, command))
+    {
+        pthread_cond_wait(&engine->wake, &engine->lock);
+    }
+    atomic_store(&engine->workerWaiting, false);
+    pthread_mutex_unlock(&engine->lock);
+}
+
+// iteration results are dropped when the render loop falls behind, they
+// are only shown and the next one replaces them anyway
+static void onIteration(const searchInfo *info, void *data)
+{
+    engineThread *engine = (engineThread *)data;
+    engineResult result = {.type = ENGINE_INFO, .info = *info, .best = info->pv[0]};
+    queuePush(&engine->results, &result);
+}
+
+static void *engineWorker(void *data)
+{
+    engineThread *engine = (engineThread *)data;
+    engineCommand command;
+    while (true)
+    {
+        nextCommand(engine, &command);
+        if (command.type == ENGINE_QUIT)
+        {
+            return NULL;
+        }
+
+        engineResult result = {.type = ENGINE_BESTMOVE};
+        result.best = search(command.position, command.limits, &engine->stop, onIteration, engine, &result.info);
+        // the bestmove must arrive, so it gets its own slot instead of a
+        // place in the queue. the next go only comes once it has been read
+        engine->bestmove = result;
+        atomic_store_explicit(&engine->bestmoveReady, true, memory_order_release);
+    }
+}
+
+bool startEngine(engineThread *engine)
+{
+    atomic_init(&engine->stop, false);
+    atomic_init(&engine->bestmoveReady, false);
+    atomic_init(&engine->workerWaiting, false);
+    engine->searching = false;
+    if (!initQueue(&engine->commands, COMMAND_QUEUE_SIZE, sizeof(engineCommand)) ||
+        !initQueue(&engine->results, RESULT_QUEUE_SIZE, sizeof(engineResult)))
+    {
+        return false;
+    }
+    if (pthread_mutex_init(&engine->lock, NULL) != 0)
+    {
+        return false;
+    }
+    if (pthread_cond_init(&engine->wake, NULL) != 0)
+    {
+        pthread_mutex_destroy(&engine->lock);
+        return false;
+    }
+    return pthread_create(&engine->thread, NULL, engineWorker, engine) == 0;
+}
+
+void quitEngine(engineThread *engine)
+{
+    engineCommand command = {.type = ENGINE_QUIT};
+    atomic_store(&engine->stop, true);
+    // at most a go is still queued, so there is room. a running search stops
+    // and leaves its bestmove in the slot, nobody reads it any more
+    queuePush(&engine->commands, &command);
+    wakeWorker(engine);
+    pthread_join(engine->thread, NULL);
+    pthread_cond_destroy(&engine->wake);
+    pthread_mutex_destroy(&engine->lock);
+    freeQueue(&engine->commands);
+    freeQueue(&engine->results);
+}
+
+bool engineGo(engineThread *engine, game position, searchLimits limits)
+{
+    engineCommand command = {.type = ENGINE_GO, .position = position, .limits = limits};
+    if (engine->searching)
+    {
+        return false;
+    }
+    // the worker only reads the stop flag once it has popped the command
+    atomic_store(&engine->stop, false);
+    engine->searching = queuePush(&engine->commands, &command);
+    if (engine->searching)
+    {
+        wakeWorker(engine);
+    }
+    return engine->searching;
+}
+
+void engineStop(engineThread *engine)
+{
+    atomic_store(&engine->stop, true);
+}
+
+bool enginePoll(engineThread *engine, engineResult *result)
+{
+    if (queuePop(&engine->results, result))
+    {
+        return true;
+    }
+    if (!atomic_load_explicit(&engine->bestmoveReady, memory_order_acquire))
+    {
+        return false;
+    }
+    // iterations pushed before the bestmove are visible now and go first
+    if (queuePop(&engine->results, result))
+    {
+        return true;
+    }
+    *result = engine->bestmove;
+    atomic_store_explicit(&engine->bestmoveReady, false, memory_order_relaxed);
+    engine->searching = false;
+    return true;
+}
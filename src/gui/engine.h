@@ -0,0 +1,68 @@
+#ifndef MEOWL_GUI_ENGINE_H
+#define MEOWL_GUI_ENGINE_H
+
+#include <pthread.h>
+#include "bitboards.h"
+#include "search.h"
+#include "queue.h"
+
+// the search runs on its own thread so the render loop never waits on it.
+// commands go in and iterations come out through single producer/single
+// consumer queues, the bestmove through its own slot. the render loop is the
+// only thread calling these. only engineGo and quitEngine take a lock, and
+// only to wake the worker when it sleeps
+typedef enum
+{
+    ENGINE_GO,
+    ENGINE_QUIT
+} engineCommandType;
+
+typedef struct
+{
+    engineCommandType type;
+    game position;
+    searchLimits limits;
+} engineCommand;
+
+typedef enum
+{
+    ENGINE_INFO,    // a completed iteration
+    ENGINE_BESTMOVE // the search is over
+} engineResultType;
+
+typedef struct
+{
+    engineResultType type;
+    searchInfo info;
+    move best; // original == -1 if there was no legal move
+} engineResult;
+
+typedef struct
+{
+    pthread_t thread;
+    spscQueue commands;
+    spscQueue results;         // iterations
+    engineResult bestmove;     // written by the worker before bestmoveReady
+    atomic_bool bestmoveReady;
+    pthread_mutex_t lock;      // only for the idle worker's sleep on wake
+    pthread_cond_t wake;
+    atomic_bool workerWaiting; // the worker is asleep or about to be
+    atomic_bool stop;
+    bool searching;            // a go was sent and its bestmove not yet received
+} engineThread;
+
+bool startEngine(engineThread *engine);
+
+// asks the engine to quit and waits for the thread
+void quitEngine(engineThread *engine);
+
+// false if a search is already running
+bool engineGo(engineThread *engine, game position, searchLimits limits);
+
+// makes the running search return its bestmove as soon as possible
+void engineStop(engineThread *engine);
+
+// next result of the search, false if there is none yet. never blocks
+bool enginePoll(engineThread *engine, engineResult *result);
+
+#endif
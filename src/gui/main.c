@@ -0,0 +1,268 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "raylib.h"
+#include "raymath.h"
+#include "bitboards.h"
+#include "engine.h"
+#include "resources.h"
+
+#define WINDOW_HEIGHT 960
+#define WINDOW_WIDTH 960
+#define BOARD_PADDING 8
+#define STATUS_HEIGHT 32
+#define ENGINE_MOVE_TIME 1000
+#define PIECE_KINDS 6
+#define PIECE_SIZE 128 // pixels per piece in the atlas
+#define HIGHLIGHT_COLOR ((Color){255, 210, 60, 110})
+#define LIGHT_COLOR ((Color){255, 255, 255, 255})
+#define DARK_COLOR ((Color){170, 170, 170, 255})
+#define BORDER_COLOR ((Color){102, 102, 102, 255})
+
+// ***************************
+// graphics related operations
+// ***************************
+
+Vector2 getCoordinate(int size, char file, int rank)
+{
+    int sqWidth = (size - 2 * BOARD_PADDING) / X_WIDTH;
+    int sqHeight = (size - 2 * BOARD_PADDING) / Y_WIDTH;
+
+    return (Vector2){BOARD_PADDING + sqWidth * file, BOARD_PADDING + sqHeight * rank};
+}
+
+// the 12 piece images packed into one texture, white then black, each side
+// king, queen, rook, bishop, knight, pawn. the pixels are compiled in (see
+// resources.h), and drawing every piece from one texture lets raylib batch
+// the whole position into a single draw call
+Texture2D loadPieceAtlas(void)
+{
+    Image atlas = {.data = (void *)pieceAtlas,
+                   .width = PIECE_ATLAS_WIDTH,
+                   .height = PIECE_ATLAS_HEIGHT,
+                   .mipmaps = 1,
+                   .format = PIECE_ATLAS_FORMAT};
+    Texture2D texture = LoadTextureFromImage(atlas);
+    SetTextureFilter(texture, TEXTURE_FILTER_BILINEAR);
+    return texture;
+}
+
+// atlas index of the piece on every square, -1 for empty squares. walks the
+// set bits of each bitboard instead of testing all 64 squares
+void fillPieceLookup(board board, int pieces[64])
+{
+    const bitboard kinds[PIECE_KINDS] = {board.king, board.queen, board.rook, board.bishop, board.knight, board.pawn};
+    for (int i = 0; i < 64; i++)
+    {
+        pieces[i] = -1;
+    }
+    for (int kind = 0; kind < PIECE_KINDS; kind++)
+    {
+        for (bitboard bits = kinds[kind]; bits; bits &= bits - 1)
+        {
+            int square = __builtin_ctzll(bits);
+            pieces[square] = (board.white >> square & 1) ? kind : PIECE_KINDS + kind;
+        }
+    }
+}
+
+void renderBoard(board board, Texture2D atlas, int size)
+{
+    int sqWidth = (size - 2 * BOARD_PADDING) / X_WIDTH;
+    int sqHeight = (size - 2 * BOARD_PADDING) / Y_WIDTH;
+    int pieces[64];
+    fillPieceLookup(board, pieces);
+    for (int square = 0; square < 64; square++)
+    {
+        if (pieces[square] < 0)
+        {
+            continue;
+        }
+        Vector2 corner = getCoordinate(size, square % X_WIDTH, square / X_WIDTH);
+        Rectangle source = {(pieces[square] % PIECE_KINDS) * PIECE_SIZE, (pieces[square] / PIECE_KINDS) * PIECE_SIZE,
+                            PIECE_SIZE, PIECE_SIZE};
+        DrawTexturePro(atlas, source, (Rectangle){corner.x, corner.y, sqWidth, sqHeight}, (Vector2){0, 0}, 0, WHITE);
+    }
+}
+
+void drawSquares(int size)
+{
+    int sqWidth = (size - 2 * BOARD_PADDING) / X_WIDTH;
+    int sqHeight = (size - 2 * BOARD_PADDING) / Y_WIDTH;
+    DrawRectangle(0, 0, size, size, BORDER_COLOR);
+    for (int square = 0; square < 64; square++)
+    {
+        int file = square % X_WIDTH;
+        int rank = square / X_WIDTH;
+        Vector2 corner = getCoordinate(size, file, rank);
+        DrawRectangle(corner.x, corner.y, sqWidth, sqHeight, (file + rank) % 2 == 0 ? LIGHT_COLOR : DARK_COLOR);
+    }
+}
+
+void drawHighlight(move lastMove, int size)
+{
+    if (lastMove.original == -1)
+    {
+        return;
+    }
+    int sqWidth = (size - 2 * BOARD_PADDING) / X_WIDTH;
+    int sqHeight = (size - 2 * BOARD_PADDING) / Y_WIDTH;
+    const int squares[2] = {lastMove.original, lastMove.next};
+    for (int i = 0; i < 2; i++)
+    {
+        Vector2 corner = getCoordinate(size, squares[i] % X_WIDTH, squares[i] / X_WIDTH);
+        DrawRectangle(corner.x, corner.y, sqWidth, sqHeight, HIGHLIGHT_COLOR);
+    }
+}
+
+// ***********************
+// cached board rendering
+// ***********************
+
+// the board, last move highlight and pieces are drawn into a render texture
+// only when one of them changes. every other frame just copies the texture
+typedef struct
+{
+    RenderTexture2D target;
+    int size;   // board side in pixels, 0 before the first render
+    bool dirty; // position or highlight changed since the last render
+} boardView;
+
+// the board is the largest square that fits above the status line
+int boardSize(void)
+{
+    int width = GetScreenWidth();
+    int height = GetScreenHeight() - STATUS_HEIGHT;
+    return width < height ? width : height;
+}
+
+void updateBoardView(boardView *view, board board, move lastMove, Texture2D atlas)
+{
+    int size = boardSize();
+    if (size != view->size)
+    {
+        if (view->size > 0)
+        {
+            UnloadRenderTexture(view->target);
+        }
+        view->target = LoadRenderTexture(size, size);
+        view->size = size;
+        view->dirty = true;
+    }
+    if (!view->dirty)
+    {
+        return;
+    }
+    BeginTextureMode(view->target);
+    drawSquares(size);
+    drawHighlight(lastMove, size);
+    renderBoard(board, atlas, size);
+    EndTextureMode();
+    view->dirty = false;
+}
+
+// the latest search result as one line of text
+void formatStatus(const engineResult *result, char *out, size_t size)
+{
+    const searchInfo *info = &result->info;
+    int length = snprintf(out, size, "depth %d  score %d  nodes %llu  pv", info->depth, info->score,
+                          (unsigned long long)info->nodes);
+    for (int i = 0; i < info->pvLength && i < 8 && length < (int)size - 8; i++)
+    {
+        char text[6];
+        moveToString(info->pv[i], text);
+        length += snprintf(out + length, size - length, " %s", text);
+    }
+}
+
+// ****************
+// graphics program
+// ****************
+
+int main(void)
+{
+    SetConfigFlags(FLAG_WINDOW_RESIZABLE);
+    InitWindow(WINDOW_WIDTH, WINDOW_HEIGHT + STATUS_HEIGHT, "Meowl Chess");
+    SetTargetFPS(60);
+
+    Texture2D atlas = loadPieceAtlas();
+
+    game game = newGame();
+
+    game.moves.head = 0;
+    game.moves.foot = 0;
+
+    // the engine plays both sides on its own thread, the loop below only
+    // picks up its results between frames
+    engineThread engine;
+    if (!startEngine(&engine))
+    {
+        fprintf(stderr, "could not start the engine thread\n");
+        CloseWindow();
+        return 1;
+    }
+    searchLimits limits = {.time = ENGINE_MOVE_TIME};
+    char status[256] = "space: pause";
+    bool gameOver = false;
+    bool paused = false;
+    bool waitingForEvents = false;
+    move lastMove = {-1, -1, 0};
+    boardView view = {.size = 0, .dirty = true};
+
+    while (!WindowShouldClose())
+    {
+        engineResult result;
+        while (enginePoll(&engine, &result))
+        {
+            if (result.type == ENGINE_INFO)
+            {
+                formatStatus(&result, status, sizeof(status));
+            }
+            else if (result.best.original == -1)
+            {
+                gameOver = true;
+                snprintf(status, sizeof(status), "game over");
+            }
+            else
+            {
+                executeMove(&game, result.best);
+                lastMove = result.best;
+                view.dirty = true;
+            }
+        }
+        if (IsKeyPressed(KEY_SPACE))
+        {
+            paused = !paused;
+        }
+        if (!engine.searching && !gameOver && !paused)
+        {
+            engineGo(&engine, game, limits);
+        }
+
+        // results from the engine thread are no window events, so the loop
+        // only sleeps until the next event while no search is running
+        if (waitingForEvents != !engine.searching)
+        {
+            waitingForEvents = !engine.searching;
+            waitingForEvents ? EnableEventWaiting() : DisableEventWaiting();
+        }
+
+        updateBoardView(&view, game.board, lastMove, atlas);
+
+        BeginDrawing();
+        ClearBackground(WHITE);
+        // render textures are stored upside down
+        DrawTextureRec(view.target.texture, (Rectangle){0, 0, view.size, -view.size}, (Vector2){0, 0}, WHITE);
+        DrawText(status, BOARD_PADDING, view.size + BOARD_PADDING, STATUS_HEIGHT - 2 * BOARD_PADDING, DARKGRAY);
+        EndDrawing();
+    }
+
+    quitEngine(&engine);
+
+    UnloadRenderTexture(view.target);
+    UnloadTexture(atlas);
+
+    CloseWindow();
+
+    return 0;
+}
@@ -0,0 +1,45 @@
+#include <stdlib.h>
+#include <string.h>
+#include "queue.h"
+
+bool initQueue(spscQueue *queue, size_t capacity, size_t itemSize)
+{
+    queue->slots = (unsigned char *)malloc(capacity * itemSize);
+    queue->capacity = capacity;
+    queue->itemSize = itemSize;
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+    return queue->slots != NULL && capacity > 0 && (capacity & (capacity - 1)) == 0;
+}
+
+void freeQueue(spscQueue *queue)
+{
+    free(queue->slots);
+    queue->slots = NULL;
+}
+
+// head and tail only ever grow, the slot is the position modulo capacity.
+// the release store publishes the copied item to the other thread
+bool queuePush(spscQueue *queue, const void *item)
+{
+    size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    if (tail - atomic_load_explicit(&queue->head, memory_order_acquire) == queue->capacity)
+    {
+        return false;
+    }
+    memcpy(queue->slots + (tail & (queue->capacity - 1)) * queue->itemSize, item, queue->itemSize);
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+bool queuePop(spscQueue *queue, void *item)
+{
+    size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    if (head == atomic_load_explicit(&queue->tail, memory_order_acquire))
+    {
+        return false;
+    }
+    memcpy(item, queue->slots + (head & (queue->capacity - 1)) * queue->itemSize, queue->itemSize);
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+    return true;
+}
@@ -0,0 +1,26 @@
+#ifndef MEOWL_QUEUE_H
+#define MEOWL_QUEUE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+// lock-free ring buffer for exactly one producer thread and one consumer
+// thread. items are copied in and out, capacity must be a power of two
+typedef struct
+{
+    _Alignas(64) atomic_size_t head; // next slot to read, written by the consumer only
+    _Alignas(64) atomic_size_t tail; // next slot to write, written by the producer only
+    size_t capacity;
+    size_t itemSize;
+    unsigned char *slots;
+} spscQueue;
+
+bool initQueue(spscQueue *queue, size_t capacity, size_t itemSize);
+void freeQueue(spscQueue *queue);
+
+// both return false instead of waiting, when the queue is full or empty
+bool queuePush(spscQueue *queue, const void *item);
+bool queuePop(spscQueue *queue, void *item);
+
+#endif
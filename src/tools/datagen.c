@@ -0,0 +1,306 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "search.h"
+#include "fen.h"
+#include "zobrist.h"
+#include "packed.h"
+
+// plays fixed-node self-play games on every core and writes the positions
+// they pass through as 32 byte trainingRecords (see packed.h): the position,
+// the search score and the game's result. each thread fills its own buffer
+// and appends it to the file in one write when it is full.
+//
+//   datagen output.bin [--games N] [--threads N] [--nodes N] [--random-plies N] [--seed S]
+//
+// games start with a few random moves. positions in check, positions whose
+// best move is a capture or promotion and mate scores are left out, so the
+// records are quiet enough to train an evaluation on
+
+#define MAX_GAME_PLIES 600
+#define WRITE_BUFFER_RECORDS 32768 // 1 MB
+// adjudicate once the score has stayed beyond this for ADJUDICATE_PLIES plies
+#define ADJUDICATE_SCORE 2000
+#define ADJUDICATE_PLIES 8
+
+typedef struct
+{
+    FILE *file;
+    int games;
+    int threads;
+    searchLimits limits;
+    int randomPlies;
+    uint64_t seed;
+
+    atomic_int next;
+    atomic_ullong records;
+    atomic_int finished;
+    int64_t startTime;
+    pthread_mutex_t writeLock;
+    bool writeFailed;
+} generator;
+
+typedef struct
+{
+    trainingRecord buffer[WRITE_BUFFER_RECORDS];
+    int count;
+} writeBuffer;
+
+// ***********
+// game rules
+// ***********
+
+static uint64_t nextRandom(uint64_t *state)
+{
+    // xorshift64*
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+static bool insufficientMaterial(board board)
+{
+    if (board.pawn | board.rook | board.queen)
+    {
+        return false;
+    }
+    return numSignificantBits(board.bishop | board.knight) <= 1;
+}
+
+static bool isThreefold(const uint64_t *keys, int ply, int halfmoveClock)
+{
+    int repetitions = 0;
+    for (int i = ply - 2; i >= 0 && i >= ply - halfmoveClock; i -= 2)
+    {
+        if (keys[i] == keys[ply] && ++repetitions == 2)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool isQuietMove(board board, move played)
+{
+    bitboard to = 1ULL << played.next;
+    bool enPassant = (board.pawn >> played.original & 1) && played.original % 8 != played.next % 8;
+    return !(getPieces(board) & to) && !enPassant && played.promotion == 0;
+}
+
+// *******
+// writing
+// *******
+
+static void flushBuffer(generator *g, writeBuffer *buffer)
+{
+    if (buffer->count == 0)
+    {
+        return;
+    }
+    pthread_mutex_lock(&g->writeLock);
+    if (fwrite(buffer->buffer, sizeof(trainingRecord), buffer->count, g->file) != (size_t)buffer->count)
+    {
+        g->writeFailed = true;
+    }
+    pthread_mutex_unlock(&g->writeLock);
+    atomic_fetch_add(&g->records, buffer->count);
+    buffer->count = 0;
+}
+
+// *******
+// playing
+// *******
+
+// plays one game, its records go into the buffer once the result is known
+static void playGame(generator *g, uint64_t random, writeBuffer *buffer)
+{
+    game position;
+    parseFen(&position, STARTING_FEN);
+    for (int i = 0; i < g->randomPlies; i++)
+    {
+        move *moves = getValidMoves(position);
+        int count = 0;
+        while (moves[count].original != -1)
+        {
+            count++;
+        }
+        if (count == 0)
+        {
+            free(moves);
+            return; // the random moves ran into mate or stalemate
+        }
+        executeMove(&position, moves[nextRandom(&random) % count]);
+        free(moves);
+    }
+
+    trainingRecord *records = (trainingRecord *)malloc(MAX_GAME_PLIES * sizeof(trainingRecord));
+    uint64_t keys[MAX_GAME_PLIES + 1];
+    int recordCount = 0;
+    int adjudicateCount = 0;
+    int result = 1;
+    for (int ply = 0; ply < MAX_GAME_PLIES; ply++)
+    {
+        bool whiteToMove = position.metadata & WHITE_TO_MOVE;
+        keys[ply] = getPositionKey(position);
+        if (position.halfmove_clock >= 100 || isThreefold(keys, ply, position.halfmove_clock) ||
+            insufficientMaterial(position.board))
+        {
+            break;
+        }
+
+        searchInfo info;
+        move best = search(position, g->limits, NULL, NULL, NULL, &info);
+        if (best.original == -1)
+        {
+            if (inCheck(position))
+            {
+                result = whiteToMove ? 0 : 2;
+            }
+            break;
+        }
+
+        int score = whiteToMove ? info.score : -info.score;
+        adjudicateCount = abs(score) >= ADJUDICATE_SCORE ? adjudicateCount + 1 : 0;
+        if (adjudicateCount >= ADJUDICATE_PLIES)
+        {
+            result = score > 0 ? 2 : 0;
+            break;
+        }
+        if (abs(score) < MATE_BOUND && !inCheck(position) && isQuietMove(position.board, best))
+        {
+            trainingRecord *record = &records[recordCount++];
+            packPosition(position, &record->position);
+            record->score = (int16_t)score;
+            record->reserved = 0;
+        }
+        executeMove(&position, best);
+    }
+
+    for (int i = 0; i < recordCount; i++)
+    {
+        records[i].result = (uint8_t)result;
+        buffer->buffer[buffer->count++] = records[i];
+        if (buffer->count == WRITE_BUFFER_RECORDS)
+        {
+            flushBuffer(g, buffer);
+        }
+    }
+    free(records);
+}
+
+static void *generateWorker(void *data)
+{
+    generator *g = (generator *)data;
+    writeBuffer *buffer = (writeBuffer *)malloc(sizeof(writeBuffer));
+    buffer->count = 0;
+    int index;
+    while ((index = atomic_fetch_add(&g->next, 1)) < g->games)
+    {
+        // each game has its own random stream, so a run is repeatable whatever the thread count
+        uint64_t random = g->seed + (uint64_t)index * 0x9E3779B97F4A7C15ULL;
+        random = random ? random : 1;
+        playGame(g, random, buffer);
+
+        int finished = atomic_fetch_add(&g->finished, 1) + 1;
+        if (finished % 100 == 0)
+        {
+            int64_t elapsed = getTimeMs() - g->startTime;
+            unsigned long long records = atomic_load(&g->records);
+            printf("%d games, %llu positions written, %llu positions/s\n", finished, records,
+                   records * 1000 / (elapsed > 0 ? elapsed : 1));
+            fflush(stdout);
+        }
+    }
+    flushBuffer(g, buffer);
+    free(buffer);
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s output.bin [--games N] [--threads N] [--nodes N] [--random-plies N] [--seed S]\n",
+                argv[0]);
+        return 1;
+    }
+    generator g;
+    memset(&g, 0, sizeof(g));
+    g.games = 1000;
+    g.threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    g.limits.nodes = 5000;
+    g.randomPlies = 8;
+    g.seed = 1;
+    for (int i = 2; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--games") == 0)
+        {
+            g.games = atoi(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--threads") == 0)
+        {
+            g.threads = atoi(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--nodes") == 0)
+        {
+            g.limits.nodes = strtoull(argv[i + 1], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--random-plies") == 0)
+        {
+            g.randomPlies = atoi(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--seed") == 0)
+        {
+            g.seed = strtoull(argv[i + 1], NULL, 10);
+        }
+    }
+    if (g.threads < 1)
+    {
+        g.threads = 1;
+    }
+
+    // appends, so several runs can fill one file
+    g.file = fopen(argv[1], "ab");
+    if (g.file == NULL)
+    {
+        fprintf(stderr, "could not open %s\n", argv[1]);
+        return 1;
+    }
+    atomic_init(&g.next, 0);
+    atomic_init(&g.records, 0);
+    atomic_init(&g.finished, 0);
+    pthread_mutex_init(&g.writeLock, NULL);
+    g.startTime = getTimeMs();
+
+    pthread_t *workers = (pthread_t *)malloc(g.threads * sizeof(pthread_t));
+    for (int i = 0; i < g.threads; i++)
+    {
+        pthread_create(&workers[i], NULL, generateWorker, &g);
+    }
+    for (int i = 0; i < g.threads; i++)
+    {
+        pthread_join(workers[i], NULL);
+    }
+    bool ok = fclose(g.file) == 0 && !g.writeFailed;
+    int64_t elapsed = getTimeMs() - g.startTime;
+    unsigned long long records = atomic_load(&g.records);
+
+    printf("===========================\n");
+    printf("Games             : %d\n", g.games);
+    printf("Positions written : %llu (%llu bytes)\n", records, records * (unsigned long long)sizeof(trainingRecord));
+    printf("Threads           : %d\n", g.threads);
+    printf("Wall time (ms)    : %lld\n", (long long)elapsed);
+    printf("Positions/second  : %llu\n", records * 1000 / (elapsed > 0 ? elapsed : 1));
+
+    pthread_mutex_destroy(&g.writeLock);
+    free(workers);
+    if (!ok)
+    {
+        fprintf(stderr, "writing %s failed\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,284 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "search.h"
+#include "fen.h"
+#include "dataset.h"
+
+// converts training positions to and from the memory mapped dataset format
+// (see dataset.h) and inspects dataset files.
+//
+//   dataset convert input output.mds   text or raw datagen records (.bin) to a dataset
+//   dataset info file.mds [--threads N]
+//   dataset export file.mds output.txt
+//   dataset sample file.mds count [--seed S]
+//
+// a text line is a FEN or EPD position followed by the result of its game, as
+// 1-0 / 0-1 / 1/2-1/2 or as a score from white's side: [1.0] [0.5] [0.0]. a
+// search score in centipawns (white's side) may follow a bracketed result.
+// export writes this format, so text round trips
+
+#define DATA_LINE 512
+#define CONVERT_BATCH 4096
+
+// **********
+// text lines
+// **********
+
+// result of the game from the text after the position (0 loss, 1 draw, 2 win
+// for white) and the score after it, false if there is no result
+static bool parseLabels(const char *text, uint8_t *result, int16_t *score)
+{
+    *score = 0;
+    const char *bracket = strchr(text, '[');
+    if (bracket != NULL)
+    {
+        char *end;
+        float value = strtof(bracket + 1, &end);
+        if (end == bracket + 1 || value < 0 || value > 1)
+        {
+            return false;
+        }
+        *result = (uint8_t)(value * 2 + 0.5f);
+        const char *close = strchr(end, ']');
+        if (close != NULL)
+        {
+            *score = (int16_t)strtol(close + 1, NULL, 10);
+        }
+        return true;
+    }
+    if (strstr(text, "1/2-1/2") != NULL)
+    {
+        *result = 1;
+    }
+    else if (strstr(text, "1-0") != NULL)
+    {
+        *result = 2;
+    }
+    else if (strstr(text, "0-1") != NULL)
+    {
+        *result = 0;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+static void writeLine(FILE *out, const trainingRecord *record)
+{
+    static const char *results[3] = {"0.0", "0.5", "1.0"};
+    game position;
+    unpackPosition(&record->position, &position);
+    char fen[FEN_MAX];
+    writeFen(position, fen);
+    fprintf(out, "%s [%s] %d\n", fen, results[record->result <= 2 ? record->result : 1], record->score);
+}
+
+// ********
+// commands
+// ********
+
+static bool hasSuffix(const char *text, const char *suffix)
+{
+    size_t length = strlen(text);
+    size_t suffixLength = strlen(suffix);
+    return length >= suffixLength && strcmp(text + length - suffixLength, suffix) == 0;
+}
+
+static int convertFile(const char *input, const char *output)
+{
+    bool raw = hasSuffix(input, ".bin");
+    FILE *in = fopen(input, raw ? "rb" : "r");
+    if (in == NULL)
+    {
+        fprintf(stderr, "could not open %s\n", input);
+        return 1;
+    }
+    datasetWriter writer;
+    if (!createDataset(&writer, output))
+    {
+        fprintf(stderr, "could not create %s\n", output);
+        fclose(in);
+        return 1;
+    }
+
+    trainingRecord *batch = (trainingRecord *)malloc(CONVERT_BATCH * sizeof(trainingRecord));
+    uint64_t skipped = 0;
+    bool ok = true;
+    if (raw)
+    {
+        size_t count;
+        while ((count = fread(batch, sizeof(trainingRecord), CONVERT_BATCH, in)) > 0)
+        {
+            ok = appendDataset(&writer, batch, count) && ok;
+        }
+    }
+    else
+    {
+        char line[DATA_LINE];
+        int count = 0;
+        while (fgets(line, sizeof(line), in) != NULL)
+        {
+            game position;
+            trainingRecord *record = &batch[count];
+            const char *rest = parseFen(&position, line);
+            if (rest == NULL || !parseLabels(rest, &record->result, &record->score))
+            {
+                skipped += line[0] != '\n';
+                continue;
+            }
+            packPosition(position, &record->position);
+            record->reserved = 0;
+            if (++count == CONVERT_BATCH)
+            {
+                ok = appendDataset(&writer, batch, count) && ok;
+                count = 0;
+            }
+        }
+        ok = appendDataset(&writer, batch, count) && ok;
+    }
+    free(batch);
+    fclose(in);
+    uint64_t written = writer.count + writer.buffered;
+    ok = finishDataset(&writer) && ok;
+    if (!ok)
+    {
+        fprintf(stderr, "writing %s failed\n", output);
+        return 1;
+    }
+    printf("%llu positions written to %s", (unsigned long long)written, output);
+    if (skipped > 0)
+    {
+        printf(", %llu unlabelled or malformed lines skipped", (unsigned long long)skipped);
+    }
+    printf("\n");
+    return 0;
+}
+
+typedef struct
+{
+    uint64_t results[3];
+    int64_t scoreSum;
+} infoCounts;
+
+static void countRecords(const trainingRecord *records, uint32_t count, int thread, void *data)
+{
+    infoCounts *counts = (infoCounts *)data + thread;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        counts->results[records[i].result <= 2 ? records[i].result : 1]++;
+        counts->scoreSum += records[i].score;
+    }
+}
+
+static int showInfo(const dataset *set, int threads)
+{
+    infoCounts *counts = (infoCounts *)calloc(threads, sizeof(infoCounts));
+    int64_t start = getTimeMs();
+    scanDataset(set, threads, countRecords, counts);
+    int64_t elapsed = getTimeMs() - start;
+    infoCounts total = {{0, 0, 0}, 0};
+    for (int i = 0; i < threads; i++)
+    {
+        for (int r = 0; r < 3; r++)
+        {
+            total.results[r] += counts[i].results[r];
+        }
+        total.scoreSum += counts[i].scoreSum;
+    }
+    free(counts);
+
+    printf("Positions         : %llu\n", (unsigned long long)set->count);
+    printf("Chunks            : %llu\n", (unsigned long long)set->chunkCount);
+    printf("White wins        : %llu\n", (unsigned long long)total.results[2]);
+    printf("Draws             : %llu\n", (unsigned long long)total.results[1]);
+    printf("Black wins        : %llu\n", (unsigned long long)total.results[0]);
+    printf("Mean score        : %.1f\n", set->count ? (double)total.scoreSum / set->count : 0.0);
+    printf("Scan time (ms)    : %lld (%d threads)\n", (long long)elapsed, threads);
+    return 0;
+}
+
+static int exportFile(const dataset *set, const char *output)
+{
+    FILE *out = fopen(output, "w");
+    if (out == NULL)
+    {
+        fprintf(stderr, "could not create %s\n", output);
+        return 1;
+    }
+    for (uint64_t i = 0; i < set->chunkCount; i++)
+    {
+        const trainingRecord *records = (const trainingRecord *)(set->data + set->chunks[i].offset);
+        for (uint32_t j = 0; j < set->chunks[i].count; j++)
+        {
+            writeLine(out, &records[j]);
+        }
+    }
+    if (fclose(out) != 0)
+    {
+        fprintf(stderr, "writing %s failed\n", output);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "usage: %s convert input output.mds | info file.mds [--threads N] | "
+                        "export file.mds output.txt | sample file.mds count [--seed S]\n",
+                argv[0]);
+        return 1;
+    }
+    const char *command = argv[1];
+    if (strcmp(command, "convert") == 0)
+    {
+        if (argc < 4)
+        {
+            fprintf(stderr, "usage: %s convert input output.mds\n", argv[0]);
+            return 1;
+        }
+        return convertFile(argv[2], argv[3]);
+    }
+
+    dataset set;
+    if (!openDataset(&set, argv[2]))
+    {
+        fprintf(stderr, "%s is not a dataset file\n", argv[2]);
+        return 1;
+    }
+    int status = 1;
+    if (strcmp(command, "info") == 0)
+    {
+        int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+        if (argc > 4 && strcmp(argv[3], "--threads") == 0)
+        {
+            threads = atoi(argv[4]);
+        }
+        status = showInfo(&set, threads > 0 ? threads : 1);
+    }
+    else if (strcmp(command, "export") == 0 && argc > 3)
+    {
+        status = exportFile(&set, argv[3]);
+    }
+    else if (strcmp(command, "sample") == 0 && argc > 3)
+    {
+        uint64_t random = argc > 5 && strcmp(argv[4], "--seed") == 0 ? strtoull(argv[5], NULL, 10) : 1;
+        random = random ? random : 1;
+        for (long i = atol(argv[3]); i > 0 && set.count > 0; i--)
+        {
+            writeLine(stdout, sampleDataset(&set, &random));
+        }
+        status = 0;
+    }
+    else
+    {
+        fprintf(stderr, "unknown command %s\n", command);
+    }
+    closeDataset(&set);
+    return status;
+}
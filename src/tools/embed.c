@@ -0,0 +1,216 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <zlib.h>
+
+// packs the piece images into the atlas the GUI draws from and writes it as a
+// C header, so the GUI neither reads nor decodes PNG files at startup.
+//
+//   embed output.h piece.png x 12 (white king queen rook bishop knight pawn, then black)
+//
+// only non-interlaced 8 bit PNGs are read, which is what the piece sets are.
+// the atlas is stored as gray + alpha when every pixel is gray, RGBA otherwise
+
+#define PIECE_KINDS 6
+#define PIECE_SIZE 128
+
+typedef struct
+{
+    int width;
+    int height;
+    uint8_t *pixels; // RGBA
+} image;
+
+// ************
+// png decoding
+// ************
+
+static uint32_t readBigEndian(const uint8_t *bytes)
+{
+    return (uint32_t)bytes[0] << 24 | (uint32_t)bytes[1] << 16 | (uint32_t)bytes[2] << 8 | bytes[3];
+}
+
+static int paeth(int a, int b, int c)
+{
+    int p = a + b - c;
+    int pa = abs(p - a);
+    int pb = abs(p - b);
+    int pc = abs(p - c);
+    return pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+}
+
+static bool loadPng(const char *path, image *out)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    uint8_t *data = (uint8_t *)malloc(size);
+    bool ok = fread(data, 1, size, file) == (size_t)size && size > 8 && memcmp(data, "\x89PNG\r\n\x1a\n", 8) == 0;
+    fclose(file);
+
+    int channels = 0;
+    uint8_t *compressed = (uint8_t *)malloc(size);
+    size_t compressedSize = 0;
+    for (long at = 8; ok && at + 12 <= size;)
+    {
+        uint32_t length = readBigEndian(data + at);
+        const uint8_t *type = data + at + 4;
+        const uint8_t *chunk = data + at + 8;
+        if (at + 12 + (long)length > size)
+        {
+            ok = false;
+        }
+        else if (memcmp(type, "IHDR", 4) == 0)
+        {
+            out->width = (int)readBigEndian(chunk);
+            out->height = (int)readBigEndian(chunk + 4);
+            // bit depth 8, not interlaced. colour types gray, RGB, gray + alpha, RGBA
+            const int channelsByType[7] = {1, 0, 3, 0, 2, 0, 4};
+            channels = chunk[9] <= 6 ? channelsByType[chunk[9]] : 0;
+            ok = chunk[8] == 8 && chunk[12] == 0 && channels > 0;
+        }
+        else if (memcmp(type, "IDAT", 4) == 0)
+        {
+            memcpy(compressed + compressedSize, chunk, length);
+            compressedSize += length;
+        }
+        at += 12 + length;
+    }
+
+    size_t stride = (size_t)out->width * channels;
+    uLongf rawSize = (uLongf)((stride + 1) * out->height);
+    uint8_t *raw = ok ? (uint8_t *)malloc(rawSize) : NULL;
+    ok = ok && uncompress(raw, &rawSize, compressed, compressedSize) == Z_OK && rawSize == (stride + 1) * out->height;
+    if (!ok)
+    {
+        fprintf(stderr, "%s is not an 8 bit non-interlaced PNG\n", path);
+        free(data);
+        free(compressed);
+        free(raw);
+        return false;
+    }
+
+    // undo the per-row filters in place, then expand to RGBA
+    out->pixels = (uint8_t *)malloc((size_t)out->width * out->height * 4);
+    for (int y = 0; y < out->height; y++)
+    {
+        uint8_t filter = raw[y * (stride + 1)];
+        uint8_t *row = raw + y * (stride + 1) + 1;
+        uint8_t *above = y > 0 ? row - (stride + 1) : NULL;
+        for (size_t i = 0; i < stride; i++)
+        {
+            int left = i >= (size_t)channels ? row[i - channels] : 0;
+            int up = above ? above[i] : 0;
+            int upLeft = above && i >= (size_t)channels ? above[i - channels] : 0;
+            const int predictors[5] = {0, left, up, (left + up) / 2, paeth(left, up, upLeft)};
+            row[i] = (uint8_t)(row[i] + (filter <= 4 ? predictors[filter] : 0));
+        }
+        for (int x = 0; x < out->width; x++)
+        {
+            const uint8_t *in = row + x * channels;
+            uint8_t *pixel = out->pixels + ((size_t)y * out->width + x) * 4;
+            bool gray = channels <= 2;
+            pixel[0] = in[0];
+            pixel[1] = gray ? in[0] : in[1];
+            pixel[2] = gray ? in[0] : in[2];
+            pixel[3] = channels == 2 ? in[1] : channels == 4 ? in[3] : 255;
+        }
+    }
+    free(data);
+    free(compressed);
+    free(raw);
+    return true;
+}
+
+// *******
+// packing
+// *******
+
+// nearest neighbour, the piece sets already come at PIECE_SIZE
+static void drawInto(image *atlas, const image *piece, int left, int top)
+{
+    for (int y = 0; y < PIECE_SIZE; y++)
+    {
+        for (int x = 0; x < PIECE_SIZE; x++)
+        {
+            const uint8_t *from = piece->pixels + ((size_t)(y * piece->height / PIECE_SIZE) * piece->width +
+                                                   x * piece->width / PIECE_SIZE) * 4;
+            memcpy(atlas->pixels + ((size_t)(top + y) * atlas->width + left + x) * 4, from, 4);
+        }
+    }
+}
+
+static bool writeHeader(const char *path, const image *atlas)
+{
+    size_t count = (size_t)atlas->width * atlas->height;
+    bool gray = true;
+    for (size_t i = 0; i < count && gray; i++)
+    {
+        const uint8_t *pixel = atlas->pixels + i * 4;
+        gray = pixel[0] == pixel[1] && pixel[1] == pixel[2];
+    }
+
+    FILE *file = fopen(path, "w");
+    if (file == NULL)
+    {
+        fprintf(stderr, "cannot write %s\n", path);
+        return false;
+    }
+    fprintf(file, "// generated by src/tools/embed.c (make resources), do not edit\n");
+    fprintf(file, "#ifndef MEOWL_RESOURCES_H\n#define MEOWL_RESOURCES_H\n\n");
+    fprintf(file, "#define PIECE_ATLAS_WIDTH %d\n#define PIECE_ATLAS_HEIGHT %d\n", atlas->width, atlas->height);
+    fprintf(file, "#define PIECE_ATLAS_FORMAT %s\n\n",
+            gray ? "PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA" : "PIXELFORMAT_UNCOMPRESSED_R8G8B8A8");
+    fprintf(file, "static const unsigned char pieceAtlas[] = {\n");
+    int column = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        const uint8_t *pixel = atlas->pixels + i * 4;
+        int channels = gray ? 2 : 4;
+        for (int c = 0; c < channels; c++)
+        {
+            int value = gray && c == 1 ? pixel[3] : pixel[c];
+            fprintf(file, "%d,", value);
+            column += value < 10 ? 2 : value < 100 ? 3 : 4;
+            if (column >= 116)
+            {
+                fprintf(file, "\n");
+                column = 0;
+            }
+        }
+    }
+    fprintf(file, "%s};\n\n#endif\n", column ? "\n" : "");
+    return fclose(file) == 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2 + PIECE_KINDS * 2)
+    {
+        fprintf(stderr, "usage: %s output.h <12 piece PNGs>\n", argv[0]);
+        return 1;
+    }
+    image atlas = {PIECE_KINDS * PIECE_SIZE, 2 * PIECE_SIZE, NULL};
+    atlas.pixels = (uint8_t *)calloc((size_t)atlas.width * atlas.height, 4);
+    for (int i = 0; i < PIECE_KINDS * 2; i++)
+    {
+        image piece;
+        if (!loadPng(argv[2 + i], &piece))
+        {
+            return 1;
+        }
+        drawInto(&atlas, &piece, (i % PIECE_KINDS) * PIECE_SIZE, (i / PIECE_KINDS) * PIECE_SIZE);
+        free(piece.pixels);
+    }
+    bool ok = writeHeader(argv[1], &atlas);
+    free(atlas.pixels);
+    return ok ? 0 : 1;
+}
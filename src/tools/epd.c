@@ -0,0 +1,319 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "search.h"
+#include "fen.h"
+#include "san.h"
+
+// solves an EPD test suite (WAC, STS, ...) on a pool of threads, each
+// position searched with its own time/node/depth budget.
+//
+//   epd file.epd [--threads N] [--time ms] [--nodes N] [--depth N]
+
+#define MAX_EPD_MOVES 8
+#define EPD_LINE 1024
+
+typedef struct
+{
+    game game;
+    char id[64];
+    move best[MAX_EPD_MOVES]; // bm
+    int bestCount;
+    move avoid[MAX_EPD_MOVES]; // am
+    int avoidCount;
+
+    // results
+    move found;
+    bool solved;
+    int64_t solvedAt; // ms until the search settled on a solution, -1 if never
+    uint64_t nodes;
+    int64_t time;
+} epdPosition;
+
+typedef struct
+{
+    epdPosition *positions;
+    int count;
+    atomic_int next;
+    searchLimits limits;
+    pthread_mutex_t outputLock;
+} epdSuite;
+
+// ***********
+// EPD parsing
+// ***********
+
+static bool containsMove(const move *moves, int count, move move)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (moves[i].original == move.original && moves[i].next == move.next && moves[i].promotion == move.promotion)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// reads the SAN moves of a bm/am operand into moves
+static int parseMoveList(game game, const char *operands, const char *end, move *moves)
+{
+    int count = 0;
+    const char *c = operands;
+    while (c < end && count < MAX_EPD_MOVES)
+    {
+        while (c < end && *c == ' ')
+        {
+            c++;
+        }
+        if (c >= end)
+        {
+            break;
+        }
+        move move = sanToMove(game, c);
+        if (move.original != -1)
+        {
+            moves[count++] = move;
+        }
+        while (c < end && *c != ' ')
+        {
+            c++;
+        }
+    }
+    return count;
+}
+
+static bool parseEpd(epdPosition *position, const char *line)
+{
+    memset(position, 0, sizeof(*position));
+    const char *c = parseFen(&position->game, line);
+    if (c == NULL)
+    {
+        return false;
+    }
+
+    // opcodes: "<name> <operands>;" repeated
+    while (*c != 0)
+    {
+        while (*c == ' ')
+        {
+            c++;
+        }
+        const char *end = strchr(c, ';');
+        if (end == NULL)
+        {
+            end = c + strcspn(c, "\r\n");
+        }
+        if (end == c)
+        {
+            break;
+        }
+
+        if (strncmp(c, "bm ", 3) == 0)
+        {
+            position->bestCount = parseMoveList(position->game, c + 3, end, position->best);
+        }
+        else if (strncmp(c, "am ", 3) == 0)
+        {
+            position->avoidCount = parseMoveList(position->game, c + 3, end, position->avoid);
+        }
+        else if (strncmp(c, "id ", 3) == 0)
+        {
+            const char *start = c + 3;
+            while (*start == ' ' || *start == '"')
+            {
+                start++;
+            }
+            int length = 0;
+            while (start + length < end && start[length] != '"' && length < (int)sizeof(position->id) - 1)
+            {
+                length++;
+            }
+            memcpy(position->id, start, length);
+            position->id[length] = 0;
+        }
+        c = *end == ';' ? end + 1 : end;
+    }
+    return position->bestCount > 0 || position->avoidCount > 0;
+}
+
+// ******
+// solver
+// ******
+
+static bool isSolution(const epdPosition *position, move move)
+{
+    if (position->bestCount > 0 && !containsMove(position->best, position->bestCount, move))
+    {
+        return false;
+    }
+    return !containsMove(position->avoid, position->avoidCount, move);
+}
+
+// remembers when the search last switched onto a solution and stayed there
+static void trackSolution(const searchInfo *info, void *data)
+{
+    epdPosition *position = (epdPosition *)data;
+    if (info->pvLength == 0)
+    {
+        return;
+    }
+    if (isSolution(position, info->pv[0]))
+    {
+        if (position->solvedAt < 0)
+        {
+            position->solvedAt = info->time;
+        }
+    }
+    else
+    {
+        position->solvedAt = -1;
+    }
+}
+
+static void *solveWorker(void *data)
+{
+    epdSuite *suite = (epdSuite *)data;
+    int index;
+    while ((index = atomic_fetch_add(&suite->next, 1)) < suite->count)
+    {
+        epdPosition *position = &suite->positions[index];
+        searchInfo result;
+        position->solvedAt = -1;
+        position->found = search(position->game, suite->limits, NULL, trackSolution, position, &result);
+        position->solved = position->found.original != -1 && isSolution(position, position->found);
+        position->nodes = result.nodes;
+        position->time = result.time;
+
+        char san[SAN_MAX] = "none";
+        if (position->found.original != -1)
+        {
+            moveToSan(position->game, position->found, san);
+        }
+        pthread_mutex_lock(&suite->outputLock);
+        if (position->solved)
+        {
+            printf("%-12s solved   %-8s in %lld ms\n", position->id, san, (long long)position->solvedAt);
+        }
+        else
+        {
+            printf("%-12s failed   %-8s\n", position->id, san);
+        }
+        fflush(stdout);
+        pthread_mutex_unlock(&suite->outputLock);
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s file.epd [--threads N] [--time ms] [--nodes N] [--depth N]\n", argv[0]);
+        return 1;
+    }
+
+    epdSuite suite;
+    memset(&suite, 0, sizeof(suite));
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    suite.limits.time = 1000;
+    for (int i = 2; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--threads") == 0)
+        {
+            threads = atoi(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--time") == 0)
+        {
+            suite.limits.time = atoll(argv[i + 1]);
+        }
+        else if (strcmp(argv[i], "--nodes") == 0)
+        {
+            suite.limits.nodes = strtoull(argv[i + 1], NULL, 10);
+            suite.limits.time = 0;
+        }
+        else if (strcmp(argv[i], "--depth") == 0)
+        {
+            suite.limits.depth = atoi(argv[i + 1]);
+            suite.limits.time = 0;
+        }
+    }
+    if (threads < 1)
+    {
+        threads = 1;
+    }
+
+    FILE *file = fopen(argv[1], "r");
+    if (file == NULL)
+    {
+        fprintf(stderr, "could not open %s\n", argv[1]);
+        return 1;
+    }
+    int capacity = 256;
+    suite.positions = (epdPosition *)malloc(capacity * sizeof(epdPosition));
+    char line[EPD_LINE];
+    int lineNumber = 0;
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        lineNumber++;
+        if (suite.count == capacity)
+        {
+            capacity *= 2;
+            suite.positions = (epdPosition *)realloc(suite.positions, capacity * sizeof(epdPosition));
+        }
+        epdPosition *position = &suite.positions[suite.count];
+        if (parseEpd(position, line))
+        {
+            if (position->id[0] == 0)
+            {
+                snprintf(position->id, sizeof(position->id), "line %d", lineNumber);
+            }
+            suite.count++;
+        }
+    }
+    fclose(file);
+
+    atomic_init(&suite.next, 0);
+    pthread_mutex_init(&suite.outputLock, NULL);
+    int64_t start = getTimeMs();
+    pthread_t *workers = (pthread_t *)malloc(threads * sizeof(pthread_t));
+    for (int i = 0; i < threads; i++)
+    {
+        pthread_create(&workers[i], NULL, solveWorker, &suite);
+    }
+    for (int i = 0; i < threads; i++)
+    {
+        pthread_join(workers[i], NULL);
+    }
+    int64_t wall = getTimeMs() - start;
+
+    int solved = 0;
+    uint64_t nodes = 0;
+    int64_t searchTime = 0;
+    int64_t solveTime = 0;
+    for (int i = 0; i < suite.count; i++)
+    {
+        nodes += suite.positions[i].nodes;
+        searchTime += suite.positions[i].time;
+        if (suite.positions[i].solved)
+        {
+            solved++;
+            solveTime += suite.positions[i].solvedAt;
+        }
+    }
+
+    printf("===========================\n");
+    printf("Solved            : %d / %d\n", solved, suite.count);
+    printf("Avg time to solve : %lld ms\n", (long long)(solved ? solveTime / solved : 0));
+    printf("Threads           : %d\n", threads);
+    printf("Wall time (ms)    : %lld\n", (long long)wall);
+    printf("Nodes searched    : %llu\n", (unsigned long long)nodes);
+    printf("Nodes/second      : %llu (all threads)\n", (unsigned long long)(nodes * 1000 / (wall > 0 ? wall : 1)));
+
+    pthread_mutex_destroy(&suite.outputLock);
+    free(workers);
+    free(suite.positions);
+    return 0;
+}
@@ -0,0 +1,582 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "search.h"
+#include "timeman.h"
+#include "fen.h"
+#include "san.h"
+#include "zobrist.h"
+#include "positions.h"
+
+// plays engine A against engine B inside this process, one game per thread.
+// both sides run this build's search, so A and B differ only in their limits
+// (time odds, node counts, clock handling). every opening is played twice
+// with colours swapped.
+//
+//   match [--openings file.epd|file.pgn] [--games N] [--threads N]
+//         [--tc base+inc | --nodes N | --time ms | --depth N], --a-.../--b-... for one side
+//         [--sprt elo0 elo1] [--alpha a] [--beta b]
+//
+// --tc is in seconds (10+0.1). without --openings the bench positions are used
+
+#define MAX_GAME_PLIES 600
+#define PGN_LINE 4096
+// resign once both engines agree the score is beyond this for RESIGN_PLIES plies
+#define RESIGN_SCORE 1000
+#define RESIGN_PLIES 6
+// draw once both engines agree the score is within this for DRAW_PLIES plies,
+// after DRAW_MOVE_NUMBER full moves
+#define DRAW_SCORE 10
+#define DRAW_PLIES 10
+#define DRAW_MOVE_NUMBER 40
+
+typedef struct
+{
+    searchLimits limits; // per move, used when base is 0
+    int64_t base;        // clock in milliseconds
+    int64_t increment;
+} player;
+
+typedef struct
+{
+    game *openings;
+    int openingCount;
+    player players[2]; // A, B
+    int games;
+    atomic_int next;
+    atomic_bool stop;
+
+    // from A's point of view
+    int wins;
+    int losses;
+    int draws;
+    bool sprt;
+    double elo0;
+    double elo1;
+    double alpha;
+    double beta;
+    pthread_mutex_t lock;
+} tournament;
+
+typedef enum
+{
+    GAME_ABORTED,
+    GAME_WHITE_WINS,
+    GAME_BLACK_WINS,
+    GAME_DRAWN
+} gameResult;
+
+// ****************
+// opening loading
+// ****************
+
+static void addOpening(tournament *t, game position, int *capacity)
+{
+    if (t->openingCount == *capacity)
+    {
+        *capacity *= 2;
+        t->openings = (game *)realloc(t->openings, *capacity * sizeof(game));
+    }
+    t->openings[t->openingCount++] = position;
+}
+
+// one game per FEN or EPD line, opcodes are ignored
+static void loadEpd(tournament *t, FILE *file, int *capacity)
+{
+    char line[PGN_LINE];
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        game position;
+        if (parseFen(&position, line) != NULL)
+        {
+            addOpening(t, position, capacity);
+        }
+    }
+}
+
+// the moves of every game in the file, played out from the start or from its
+// FEN tag. a move that does not parse ends that game's opening
+static void loadPgn(tournament *t, FILE *file, int *capacity)
+{
+    char line[PGN_LINE];
+    game position;
+    parseFen(&position, STARTING_FEN);
+    bool hasMoves = false;
+    bool valid = true;
+    bool inComment = false;
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        if (line[0] == '[')
+        {
+            if (hasMoves)
+            {
+                addOpening(t, position, capacity);
+                parseFen(&position, STARTING_FEN);
+                hasMoves = false;
+                valid = true;
+            }
+            if (strncmp(line, "[FEN \"", 6) == 0)
+            {
+                parseFen(&position, line + 6);
+            }
+            continue;
+        }
+        char *save = NULL;
+        for (char *token = strtok_r(line, " \t\r\n", &save); token != NULL; token = strtok_r(NULL, " \t\r\n", &save))
+        {
+            if (inComment || token[0] == '{')
+            {
+                inComment = strchr(token, '}') == NULL;
+                continue;
+            }
+            // "12." and "12..." or "12.e4"
+            while (*token >= '0' && *token <= '9' && strchr(token, '.') != NULL)
+            {
+                token = strchr(token, '.') + 1;
+                while (*token == '.')
+                {
+                    token++;
+                }
+            }
+            if (*token == 0 || *token == '$' || !valid)
+            {
+                continue;
+            }
+            if (strcmp(token, "1-0") == 0 || strcmp(token, "0-1") == 0 || strcmp(token, "1/2-1/2") == 0 ||
+                strcmp(token, "*") == 0)
+            {
+                valid = false;
+                continue;
+            }
+            move played = sanToMove(position, token);
+            if (played.original == -1)
+            {
+                valid = false;
+                continue;
+            }
+            executeMove(&position, played);
+            hasMoves = true;
+        }
+    }
+    if (hasMoves)
+    {
+        addOpening(t, position, capacity);
+    }
+}
+
+static bool loadOpenings(tournament *t, const char *path)
+{
+    int capacity = 64;
+    t->openings = (game *)malloc(capacity * sizeof(game));
+    if (path == NULL)
+    {
+        for (int i = 0; i < BENCH_POSITION_COUNT; i++)
+        {
+            game position;
+            parseFen(&position, benchPositions[i]);
+            addOpening(t, position, &capacity);
+        }
+        return true;
+    }
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        fprintf(stderr, "could not open %s\n", path);
+        return false;
+    }
+    const char *extension = strrchr(path, '.');
+    if (extension != NULL && strcmp(extension, ".pgn") == 0)
+    {
+        loadPgn(t, file, &capacity);
+    }
+    else
+    {
+        loadEpd(t, file, &capacity);
+    }
+    fclose(file);
+    if (t->openingCount == 0)
+    {
+        fprintf(stderr, "no openings in %s\n", path);
+        return false;
+    }
+    return true;
+}
+
+// ********
+// playing
+// ********
+
+static bool insufficientMaterial(board board)
+{
+    if (board.pawn | board.rook | board.queen)
+    {
+        return false;
+    }
+    return numSignificantBits(board.bishop | board.knight) <= 1;
+}
+
+// the position occurred twice before since the last capture or pawn move
+static bool isThreefold(const uint64_t *keys, int ply, int halfmoveClock)
+{
+    int repetitions = 0;
+    for (int i = ply - 2; i >= 0 && i >= ply - halfmoveClock; i -= 2)
+    {
+        if (keys[i] == keys[ply] && ++repetitions == 2)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static gameResult playGame(tournament *t, game position, const player *white, const player *black,
+                           const char **reason)
+{
+    const player *players[2] = {white, black};
+    int64_t clocks[2] = {white->base, black->base};
+    uint64_t keys[MAX_GAME_PLIES + 1];
+    int resignCount = 0;
+    int drawCount = 0;
+    int lastScore = 0;
+
+    for (int ply = 0; ply < MAX_GAME_PLIES; ply++)
+    {
+        int side = position.metadata & WHITE_TO_MOVE ? 0 : 1;
+        keys[ply] = getPositionKey(position);
+        if (position.halfmove_clock >= 100)
+        {
+            *reason = "fifty moves";
+            return GAME_DRAWN;
+        }
+        if (isThreefold(keys, ply, position.halfmove_clock))
+        {
+            *reason = "repetition";
+            return GAME_DRAWN;
+        }
+        if (insufficientMaterial(position.board))
+        {
+            *reason = "insufficient material";
+            return GAME_DRAWN;
+        }
+
+        const player *mover = players[side];
+        searchLimits limits = mover->limits;
+        if (mover->base > 0)
+        {
+            allocateTime(&limits, clocks[side], mover->increment, 0, 0);
+        }
+        searchInfo info;
+        move best = search(position, limits, &t->stop, NULL, NULL, &info);
+        if (atomic_load(&t->stop))
+        {
+            return GAME_ABORTED;
+        }
+        if (best.original == -1)
+        {
+            bool mated = inCheck(position);
+            *reason = mated ? "checkmate" : "stalemate";
+            return mated ? (side == 0 ? GAME_BLACK_WINS : GAME_WHITE_WINS) : GAME_DRAWN;
+        }
+        if (mover->base > 0)
+        {
+            clocks[side] -= info.time;
+            if (clocks[side] < 0)
+            {
+                *reason = "time forfeit";
+                return side == 0 ? GAME_BLACK_WINS : GAME_WHITE_WINS;
+            }
+            clocks[side] += mover->increment;
+        }
+
+        // scores from white's point of view, both engines have to agree
+        int score = side == 0 ? info.score : -info.score;
+        resignCount = ply > 0 && abs(score) >= RESIGN_SCORE && abs(lastScore) >= RESIGN_SCORE &&
+                              (score > 0) == (lastScore > 0)
+                          ? resignCount + 1
+                          : 0;
+        drawCount = position.fullmove_number >= DRAW_MOVE_NUMBER && abs(score) <= DRAW_SCORE ? drawCount + 1 : 0;
+        lastScore = score;
+        if (resignCount >= RESIGN_PLIES)
+        {
+            *reason = "adjudicated win";
+            return score > 0 ? GAME_WHITE_WINS : GAME_BLACK_WINS;
+        }
+        if (drawCount >= DRAW_PLIES)
+        {
+            *reason = "adjudicated draw";
+            return GAME_DRAWN;
+        }
+        executeMove(&position, best);
+    }
+    *reason = "move limit";
+    return GAME_DRAWN;
+}
+
+// ***********
+// statistics
+// ***********
+
+static double eloFromScore(double score)
+{
+    if (score <= 0)
+    {
+        return -INFINITY;
+    }
+    if (score >= 1)
+    {
+        return INFINITY;
+    }
+    return -400 * log10(1 / score - 1);
+}
+
+static double scoreFromElo(double elo)
+{
+    return 1 / (1 + pow(10, -elo / 400));
+}
+
+// Elo difference with its 95% interval half width, from the trinomial
+// distribution of the results
+static void computeElo(int wins, int losses, int draws, double *elo, double *margin)
+{
+    int games = wins + losses + draws;
+    double score = (wins + draws / 2.0) / games;
+    double variance = (wins * pow(1 - score, 2) + losses * pow(score, 2) + draws * pow(0.5 - score, 2)) / games;
+    double error = 1.96 * sqrt(variance / games);
+    *elo = eloFromScore(score);
+    *margin = (eloFromScore(score + error) - eloFromScore(score - error)) / 2;
+    if (isnan(*margin))
+    {
+        *margin = INFINITY; // no losses or no wins yet
+    }
+}
+
+// log likelihood ratio of elo1 against elo0, normal approximation of the
+// generalised SPRT. while one kind of result has not happened yet, half a game
+// of each is added so that a one-sided start still has a variance
+static double computeLlr(int wins, int losses, int draws, double elo0, double elo1)
+{
+    double regularisation = wins == 0 || losses == 0 || draws == 0 ? 0.5 : 0;
+    double w = wins + regularisation;
+    double l = losses + regularisation;
+    double d = draws + regularisation;
+    double games = w + l + d;
+    double score = (w + d / 2) / games;
+    double variance = (w * pow(1 - score, 2) + l * pow(score, 2) + d * pow(0.5 - score, 2)) / games;
+    double score0 = scoreFromElo(elo0);
+    double score1 = scoreFromElo(elo1);
+    return (wins + losses + draws) * (score1 - score0) * (2 * score - score0 - score1) / (2 * variance);
+}
+
+static void printSummary(const tournament *t)
+{
+    double elo, margin;
+    int games = t->wins + t->losses + t->draws;
+    computeElo(t->wins, t->losses, t->draws, &elo, &margin);
+    printf("Score of A vs B: %d - %d - %d  [%.3f] %d\n", t->wins, t->losses, t->draws,
+           (t->wins + t->draws / 2.0) / games, games);
+    printf("Elo difference: %.1f +/- %.1f\n", elo, margin);
+    if (t->sprt)
+    {
+        printf("SPRT: llr %.2f (%.2f, %.2f) [%.1f, %.1f]\n", computeLlr(t->wins, t->losses, t->draws, t->elo0, t->elo1),
+               log(t->beta / (1 - t->alpha)), log((1 - t->beta) / t->alpha), t->elo0, t->elo1);
+    }
+    fflush(stdout);
+}
+
+static void *matchWorker(void *data)
+{
+    tournament *t = (tournament *)data;
+    const char *results[] = {"*", "1-0", "0-1", "1/2-1/2"};
+    int index;
+    while (!atomic_load(&t->stop) && (index = atomic_fetch_add(&t->next, 1)) < t->games)
+    {
+        // game pairs share an opening, A has white in the first of them
+        bool aIsWhite = index % 2 == 0;
+        game opening = t->openings[(index / 2) % t->openingCount];
+        const char *reason = "";
+        gameResult result = playGame(t, opening, &t->players[aIsWhite ? 0 : 1], &t->players[aIsWhite ? 1 : 0],
+                                     &reason);
+        if (result == GAME_ABORTED)
+        {
+            break;
+        }
+
+        pthread_mutex_lock(&t->lock);
+        if (result == GAME_DRAWN)
+        {
+            t->draws++;
+        }
+        else if ((result == GAME_WHITE_WINS) == aIsWhite)
+        {
+            t->wins++;
+        }
+        else
+        {
+            t->losses++;
+        }
+        int finished = t->wins + t->losses + t->draws;
+        printf("game %d  %s vs %s  %s {%s}\n", index + 1, aIsWhite ? "A" : "B", aIsWhite ? "B" : "A",
+               results[result], reason);
+        if (finished % 10 == 0)
+        {
+            printSummary(t);
+        }
+        if (t->sprt)
+        {
+            double llr = computeLlr(t->wins, t->losses, t->draws, t->elo0, t->elo1);
+            if (llr <= log(t->beta / (1 - t->alpha)) || llr >= log((1 - t->beta) / t->alpha))
+            {
+                printf("SPRT: %s accepted after %d games\n", llr > 0 ? "H1" : "H0", finished);
+                atomic_store(&t->stop, true);
+            }
+        }
+        fflush(stdout);
+        pthread_mutex_unlock(&t->lock);
+    }
+    return NULL;
+}
+
+// *********
+// options
+// *********
+
+// --tc, --nodes, --time or --depth for one player. returns false for other options
+static bool parsePlayerOption(player *p, const char *option, const char *value)
+{
+    if (strcmp(option, "tc") == 0)
+    {
+        // seconds+seconds, e.g. 10+0.1
+        const char *plus = strchr(value, '+');
+        p->base = (int64_t)(atof(value) * 1000);
+        p->increment = plus ? (int64_t)(atof(plus + 1) * 1000) : 0;
+        p->limits = (searchLimits){0};
+    }
+    else if (strcmp(option, "nodes") == 0)
+    {
+        p->limits = (searchLimits){.nodes = strtoull(value, NULL, 10)};
+        p->base = 0;
+    }
+    else if (strcmp(option, "time") == 0)
+    {
+        p->limits = (searchLimits){.time = atoll(value)};
+        p->base = 0;
+    }
+    else if (strcmp(option, "depth") == 0)
+    {
+        p->limits = (searchLimits){.depth = atoi(value)};
+        p->base = 0;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    tournament t;
+    memset(&t, 0, sizeof(t));
+    t.games = 1000;
+    t.alpha = 0.05;
+    t.beta = 0.05;
+    t.players[0].base = t.players[1].base = 10000;
+    t.players[0].increment = t.players[1].increment = 100;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    const char *openings = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *option = argv[i] + 2;
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strncmp(argv[i], "--", 2) != 0 || value == NULL)
+        {
+            fprintf(stderr,
+                    "usage: %s [--openings file.epd|file.pgn] [--games N] [--threads N]\n"
+                    "       [--tc base+inc | --nodes N | --time ms | --depth N], --a-.../--b-... for one side\n"
+                    "       [--sprt elo0 elo1] [--alpha a] [--beta b]\n",
+                    argv[0]);
+            return 1;
+        }
+        i++;
+        if (strcmp(option, "openings") == 0)
+        {
+            openings = value;
+        }
+        else if (strcmp(option, "games") == 0)
+        {
+            t.games = atoi(value);
+        }
+        else if (strcmp(option, "threads") == 0)
+        {
+            threads = atoi(value);
+        }
+        else if (strcmp(option, "sprt") == 0 && i + 1 < argc)
+        {
+            t.sprt = true;
+            t.elo0 = atof(value);
+            t.elo1 = atof(argv[++i]);
+        }
+        else if (strcmp(option, "alpha") == 0)
+        {
+            t.alpha = atof(value);
+        }
+        else if (strcmp(option, "beta") == 0)
+        {
+            t.beta = atof(value);
+        }
+        else if ((strncmp(option, "a-", 2) == 0 && parsePlayerOption(&t.players[0], option + 2, value)) ||
+                 (strncmp(option, "b-", 2) == 0 && parsePlayerOption(&t.players[1], option + 2, value)))
+        {
+            continue;
+        }
+        else if (parsePlayerOption(&t.players[0], option, value))
+        {
+            parsePlayerOption(&t.players[1], option, value);
+        }
+        else
+        {
+            fprintf(stderr, "unknown option --%s\n", option);
+            return 1;
+        }
+    }
+    if (threads < 1)
+    {
+        threads = 1;
+    }
+    if (!loadOpenings(&t, openings))
+    {
+        return 1;
+    }
+
+    atomic_init(&t.next, 0);
+    atomic_init(&t.stop, false);
+    pthread_mutex_init(&t.lock, NULL);
+    int64_t start = getTimeMs();
+    pthread_t *workers = (pthread_t *)malloc(threads * sizeof(pthread_t));
+    for (int i = 0; i < threads; i++)
+    {
+        pthread_create(&workers[i], NULL, matchWorker, &t);
+    }
+    for (int i = 0; i < threads; i++)
+    {
+        pthread_join(workers[i], NULL);
+    }
+
+    printf("===========================\n");
+    if (t.wins + t.losses + t.draws > 0)
+    {
+        printSummary(&t);
+    }
+    printf("Openings          : %d\n", t.openingCount);
+    printf("Threads           : %d\n", threads);
+    printf("Wall time (ms)    : %lld\n", (long long)(getTimeMs() - start));
+
+    pthread_mutex_destroy(&t.lock);
+    free(workers);
+    free(t.openings);
+    return 0;
+}
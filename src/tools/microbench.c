@@ -0,0 +1,513 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bitboards.h"
+#include "fen.h"
+#include "positions.h"
+#include "packed.h"
+#include "attacks.h"
+#include "pawns.h"
+#include "material.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+// times each move generator, executeMove and the bit utilities on their own
+// over the built-in position corpus.
+//
+//   microbench [--json] [--iterations N] [--fens file]
+
+#define MAX_CORPUS 4096
+
+typedef struct
+{
+    game positions[MAX_CORPUS];
+    int count;
+    // legal moves of every position, flattened, with the position each belongs to
+    move *moves;
+    int *moveOwner;
+    int moveCount;
+} corpus;
+
+typedef struct
+{
+    const char *name;
+    uint64_t (*run)(const corpus *corpus); // returns the number of calls made
+} benchmark;
+
+typedef struct
+{
+    const char *name;
+    uint64_t calls;
+    double seconds;
+    bool hasCounters;
+    uint64_t cycles;
+    uint64_t branchMisses;
+} benchmarkResult;
+
+// keeps the compiler from throwing the measured work away
+static volatile uint64_t sink;
+
+// ***************
+// timed functions
+// ***************
+
+static uint64_t runGenerator(const corpus *corpus, move *(*generator)(game))
+{
+    uint64_t total = 0;
+    for (int i = 0; i < corpus->count; i++)
+    {
+        move *moves = generator(corpus->positions[i]);
+        total += moves[0].original;
+        free(moves);
+    }
+    sink += total;
+    return corpus->count;
+}
+
+static uint64_t benchPawns(const corpus *corpus)
+{
+    return runGenerator(corpus, getPawnMoves);
+}
+
+static uint64_t benchKnights(const corpus *corpus)
+{
+    return runGenerator(corpus, getKnightMoves);
+}
+
+static uint64_t benchBishops(const corpus *corpus)
+{
+    return runGenerator(corpus, getBishopMoves);
+}
+
+static uint64_t benchRooks(const corpus *corpus)
+{
+    return runGenerator(corpus, getRookMoves);
+}
+
+static uint64_t benchQueens(const corpus *corpus)
+{
+    return runGenerator(corpus, getQueenMoves);
+}
+
+static uint64_t benchKings(const corpus *corpus)
+{
+    return runGenerator(corpus, getKingMoves);
+}
+
+static uint64_t benchExecuteMove(const corpus *corpus)
+{
+    uint64_t total = 0;
+    for (int i = 0; i < corpus->moveCount; i++)
+    {
+        game position = corpus->positions[corpus->moveOwner[i]];
+        executeMove(&position, corpus->moves[i]);
+        total += position.board.white;
+    }
+    sink += total;
+    return corpus->moveCount;
+}
+
+// the bit utilities are run over the seven bitboards of every position
+#define FOR_EACH_BITBOARD(body)                                                                 \
+    for (int i = 0; i < corpus->count; i++)                                                     \
+    {                                                                                           \
+        const board *b = &corpus->positions[i].board;                                           \
+        bitboard boards[7] = {b->king, b->queen, b->rook, b->bishop, b->knight, b->pawn, b->white}; \
+        for (int j = 0; j < 7; j++)                                                             \
+        {                                                                                       \
+            bitboard bb = boards[j];                                                            \
+            body;                                                                               \
+        }                                                                                       \
+    }
+
+static uint64_t benchNumSignificantBits(const corpus *corpus)
+{
+    uint64_t total = 0;
+    FOR_EACH_BITBOARD(total += numSignificantBits(bb));
+    sink += total;
+    return corpus->count * 7ULL;
+}
+
+static uint64_t benchTrailingZeros(const corpus *corpus)
+{
+    uint64_t total = 0;
+    // trailingZeros never returns on an empty board
+    FOR_EACH_BITBOARD(total += bb ? trailingZeros(bb) : 0);
+    sink += total;
+    return corpus->count * 7ULL;
+}
+
+static uint64_t benchGetNthSBit(const corpus *corpus)
+{
+    uint64_t total = 0;
+    FOR_EACH_BITBOARD(total += getNthSBit(bb, 1));
+    sink += total;
+    return corpus->count * 7ULL;
+}
+
+static uint64_t benchGetPieces(const corpus *corpus)
+{
+    uint64_t total = 0;
+    for (int i = 0; i < corpus->count; i++)
+    {
+        total += getPieces(corpus->positions[i].board);
+    }
+    sink += total;
+    return corpus->count;
+}
+
+static uint64_t benchSliderAttacks(const corpus *corpus)
+{
+    uint64_t total = 0;
+    for (int i = 0; i < corpus->count; i++)
+    {
+        board b = corpus->positions[i].board;
+        bitboard white = b.white;
+        bitboard black = getPieces(b) & ~b.white;
+        total += sliderAttacks((b.bishop | b.queen) & white, (b.rook | b.queen) & white, ~getPieces(b));
+        total += sliderAttacks((b.bishop | b.queen) & black, (b.rook | b.queen) & black, ~getPieces(b));
+    }
+    sink += total;
+    return corpus->count * 2ULL;
+}
+
+static uint64_t benchGetAttackedSquares(const corpus *corpus)
+{
+    uint64_t total = 0;
+    for (int i = 0; i < corpus->count; i++)
+    {
+        total += getAttackedSquares(corpus->positions[i].board, true);
+        total += getAttackedSquares(corpus->positions[i].board, false);
+    }
+    sink += total;
+    return corpus->count * 2ULL;
+}
+
+static uint64_t benchInCheck(const corpus *corpus)
+{
+    uint64_t total = 0;
+    for (int i = 0; i < corpus->count; i++)
+    {
+        total += inCheck(corpus->positions[i]);
+    }
+    sink += total;
+    return corpus->count;
+}
+
+// the pawn structure worked out every time, what a pawn hash miss costs
+static uint64_t benchPawnFeatures(const corpus *corpus)
+{
+    uint64_t total = 0;
+    for (int i = 0; i < corpus->count; i++)
+    {
+        int features[PAWN_FEATURES];
+        pawnFeatures(corpus->positions[i].board, features);
+        total += features[PAWN_DOUBLED] + features[PAWN_ISOLATED];
+    }
+    sink += total;
+    return corpus->count;
+}
+
+// mostly hits after the first repetition
+static uint64_t benchProbePawns(const corpus *corpus)
+{
+    uint64_t total = 0;
+    for (int i = 0; i < corpus->count; i++)
+    {
+        total += probePawns(corpus->positions[i].board)->score;
+    }
+    sink += total;
+    return corpus->count;
+}
+
+static uint64_t benchProbeMaterial(const corpus *corpus)
+{
+    uint64_t total = 0;
+    for (int i = 0; i < corpus->count; i++)
+    {
+        total += probeMaterial(corpus->positions[i].board)->phase;
+    }
+    sink += total;
+    return corpus->count;
+}
+
+static packedPosition packedCorpus[MAX_CORPUS];
+static game unpackedCorpus[MAX_CORPUS];
+
+static uint64_t benchPackPositions(const corpus *corpus)
+{
+    packPositions(corpus->positions, packedCorpus, corpus->count);
+    sink += packedCorpus[corpus->count - 1].occupancy[0];
+    return corpus->count;
+}
+
+static uint64_t benchUnpackPositions(const corpus *corpus)
+{
+    unpackPositions(packedCorpus, unpackedCorpus, corpus->count);
+    sink += unpackedCorpus[corpus->count - 1].board.white;
+    return corpus->count;
+}
+
+static const benchmark benchmarks[] = {
+    {"getPawnMoves", benchPawns},
+    {"getKnightMoves", benchKnights},
+    {"getBishopMoves", benchBishops},
+    {"getRookMoves", benchRooks},
+    {"getQueenMoves", benchQueens},
+    {"getKingMoves", benchKings},
+    {"executeMove", benchExecuteMove},
+    {"numSignificantBits", benchNumSignificantBits},
+    {"trailingZeros", benchTrailingZeros},
+    {"getNthSBit", benchGetNthSBit},
+    {"getPieces", benchGetPieces},
+    {"sliderAttacks", benchSliderAttacks},
+    {"getAttackedSquares", benchGetAttackedSquares},
+    {"inCheck", benchInCheck},
+    {"pawnFeatures", benchPawnFeatures},
+    {"probePawns", benchProbePawns},
+    {"probeMaterial", benchProbeMaterial},
+    {"packPositions", benchPackPositions},
+    {"unpackPositions", benchUnpackPositions}, // after packPositions, which fills packedCorpus
+};
+
+// ****************
+// hardware counters
+// ****************
+
+typedef struct
+{
+    int cycles;
+    int branchMisses;
+} counters;
+
+#ifdef __linux__
+static int openCounter(uint64_t config, int group)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = group == -1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+// both counters in one group so they cover exactly the same instructions
+static counters openCounters(void)
+{
+    counters c = {-1, -1};
+    c.cycles = openCounter(PERF_COUNT_HW_CPU_CYCLES, -1);
+    if (c.cycles >= 0)
+    {
+        c.branchMisses = openCounter(PERF_COUNT_HW_BRANCH_MISSES, c.cycles);
+        if (c.branchMisses < 0)
+        {
+            close(c.cycles);
+            c.cycles = -1;
+        }
+    }
+    return c;
+}
+
+static void startCounters(counters c)
+{
+    if (c.cycles >= 0)
+    {
+        ioctl(c.cycles, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(c.cycles, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+}
+
+static bool stopCounters(counters c, uint64_t *cycles, uint64_t *branchMisses)
+{
+    if (c.cycles < 0)
+    {
+        return false;
+    }
+    ioctl(c.cycles, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    return read(c.cycles, cycles, sizeof(*cycles)) == sizeof(*cycles) &&
+           read(c.branchMisses, branchMisses, sizeof(*branchMisses)) == sizeof(*branchMisses);
+}
+#else
+static counters openCounters(void)
+{
+    return (counters){-1, -1};
+}
+
+static void startCounters(counters c)
+{
+    (void)c;
+}
+
+static bool stopCounters(counters c, uint64_t *cycles, uint64_t *branchMisses)
+{
+    (void)c;
+    (void)cycles;
+    (void)branchMisses;
+    return false;
+}
+#endif
+
+// ******
+// driver
+// ******
+
+static double nowSeconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static bool loadCorpus(corpus *corpus, const char *path)
+{
+    corpus->count = 0;
+    if (path == NULL)
+    {
+        for (int i = 0; i < BENCH_POSITION_COUNT; i++)
+        {
+            parseFen(&corpus->positions[corpus->count++], benchPositions[i]);
+        }
+    }
+    else
+    {
+        FILE *file = fopen(path, "r");
+        if (file == NULL)
+        {
+            return false;
+        }
+        char line[512];
+        while (corpus->count < MAX_CORPUS && fgets(line, sizeof(line), file) != NULL)
+        {
+            if (parseFen(&corpus->positions[corpus->count], line) != NULL)
+            {
+                corpus->count++;
+            }
+        }
+        fclose(file);
+    }
+
+    corpus->moves = (move *)malloc(corpus->count * MAX_MOVES * sizeof(move));
+    corpus->moveOwner = (int *)malloc(corpus->count * MAX_MOVES * sizeof(int));
+    corpus->moveCount = 0;
+    for (int i = 0; i < corpus->count; i++)
+    {
+        move *moves = getValidMoves(corpus->positions[i]);
+        for (int j = 0; moves[j].original != -1; j++)
+        {
+            corpus->moves[corpus->moveCount] = moves[j];
+            corpus->moveOwner[corpus->moveCount] = i;
+            corpus->moveCount++;
+        }
+        free(moves);
+    }
+    return corpus->count > 0;
+}
+
+int main(int argc, char **argv)
+{
+    bool json = false;
+    int iterations = 200;
+    const char *fens = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--json") == 0)
+        {
+            json = true;
+        }
+        else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+        {
+            iterations = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--fens") == 0 && i + 1 < argc)
+        {
+            fens = argv[++i];
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--json] [--iterations N] [--fens file]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    corpus *corpus = malloc(sizeof(*corpus));
+    if (!loadCorpus(corpus, fens))
+    {
+        fprintf(stderr, "could not load positions from %s\n", fens);
+        return 1;
+    }
+
+    counters hw = openCounters();
+    int count = sizeof(benchmarks) / sizeof(benchmarks[0]);
+    benchmarkResult results[sizeof(benchmarks) / sizeof(benchmarks[0])];
+
+    for (int b = 0; b < count; b++)
+    {
+        benchmarks[b].run(corpus); // warm up caches and branch predictors
+
+        benchmarkResult *result = &results[b];
+        result->name = benchmarks[b].name;
+        result->calls = 0;
+        startCounters(hw);
+        double start = nowSeconds();
+        for (int i = 0; i < iterations; i++)
+        {
+            result->calls += benchmarks[b].run(corpus);
+        }
+        result->seconds = nowSeconds() - start;
+        result->hasCounters = stopCounters(hw, &result->cycles, &result->branchMisses);
+    }
+
+    if (json)
+    {
+        printf("{\n  \"positions\": %d,\n  \"iterations\": %d,\n  \"benchmarks\": [\n", corpus->count, iterations);
+        for (int b = 0; b < count; b++)
+        {
+            benchmarkResult *r = &results[b];
+            printf("    {\"name\": \"%s\", \"calls\": %llu, \"ns_per_call\": %.3f, \"calls_per_sec\": %.0f", r->name,
+                   (unsigned long long)r->calls, r->seconds * 1e9 / r->calls, r->calls / r->seconds);
+            if (r->hasCounters)
+            {
+                printf(", \"cycles_per_call\": %.2f, \"branch_misses_per_call\": %.4f}", (double)r->cycles / r->calls,
+                       (double)r->branchMisses / r->calls);
+            }
+            else
+            {
+                printf(", \"cycles_per_call\": null, \"branch_misses_per_call\": null}");
+            }
+            printf("%s\n", b + 1 < count ? "," : "");
+        }
+        printf("  ]\n}\n");
+    }
+    else
+    {
+        printf("%d positions, %d legal moves, %d iterations\n\n", corpus->count, corpus->moveCount, iterations);
+        printf("%-20s %12s %14s %12s %14s\n", "function", "ns/call", "calls/sec", "cycles/call", "br-miss/call");
+        for (int b = 0; b < count; b++)
+        {
+            benchmarkResult *r = &results[b];
+            printf("%-20s %12.2f %14.0f", r->name, r->seconds * 1e9 / r->calls, r->calls / r->seconds);
+            if (r->hasCounters)
+            {
+                printf(" %12.1f %14.3f\n", (double)r->cycles / r->calls, (double)r->branchMisses / r->calls);
+            }
+            else
+            {
+                printf(" %12s %14s\n", "n/a", "n/a");
+            }
+        }
+    }
+
+    free(corpus->moves);
+    free(corpus->moveOwner);
+    free(corpus);
+    return 0;
+}
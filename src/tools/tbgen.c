@@ -0,0 +1,820 @@
+#include <stdio.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include "egtb.h"
+#include "search.h"
+
+// builds Meowl's endgame tables (see egtb.h) by retrograde analysis. pass n
+// settles every position that is mated or mates in exactly n plies, reading
+// the values settled by the previous passes. each pass is split between
+// threads, which only write the positions they own.
+//
+//   tbgen directory [--threads N] [all | KQK KRK KPK KBNK ...]
+//
+// tables reached by captures and promotions are generated first.
+
+#define CHUNK 65536
+#define MAX_CHILDREN 128
+#define UNSOLVED 0
+#define SETTLED_DRAW 255 // illegal position or stalemate, stored as a draw
+#define MAX_TB_PLIES 253
+
+typedef struct
+{
+    int pieces[EGTB_MAX_PIECES];
+    int squares[EGTB_MAX_PIECES];
+    int count;
+    bool whiteToMove;
+} tbPosition;
+
+typedef struct
+{
+    tbPosition position;
+    bool sameMaterial;
+    int doublePush; // square of a pawn that just moved two squares, -1 if none
+} tbChild;
+
+typedef struct
+{
+    egtbMaterial material;
+    uint8_t *current; // values after the previous pass
+    uint8_t *next;    // values written by this pass
+    int pass;
+    atomic_ullong nextChunk;
+    atomic_ullong changed;
+} generation;
+
+static bitboard kingAttacks[64];
+static bitboard knightAttacks[64];
+static bitboard pawnAttacks[2][64];
+static bitboard between[64][64];
+static int lineKind[64][64]; // 1 along a rank or file, 2 along a diagonal
+
+static const int directions[8][2] = {{0, 1}, {1, 0}, {0, -1}, {-1, 0}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+
+// **************
+// attack tables
+// **************
+
+static bool onBoard(int file, int rank)
+{
+    return file >= 0 && file < 8 && rank >= 0 && rank < 8;
+}
+
+static void initAttacks(void)
+{
+    const int knightJumps[8][2] = {{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+    for (int s = 0; s < 64; s++)
+    {
+        int file = s & 7;
+        int rank = s >> 3;
+        for (int d = 0; d < 8; d++)
+        {
+            if (onBoard(file + directions[d][0], rank + directions[d][1]))
+            {
+                kingAttacks[s] |= 1ULL << (s + directions[d][1] * 8 + directions[d][0]);
+            }
+            if (onBoard(file + knightJumps[d][0], rank + knightJumps[d][1]))
+            {
+                knightAttacks[s] |= 1ULL << (s + knightJumps[d][1] * 8 + knightJumps[d][0]);
+            }
+
+            bitboard ray = 0;
+            for (int f = file + directions[d][0], r = rank + directions[d][1]; onBoard(f, r);
+                 f += directions[d][0], r += directions[d][1])
+            {
+                between[s][r * 8 + f] = ray;
+                lineKind[s][r * 8 + f] = d < 4 ? 1 : 2;
+                ray |= 1ULL << (r * 8 + f);
+            }
+        }
+        for (int side = -1; side <= 1; side += 2)
+        {
+            if (onBoard(file + side, rank + 1))
+            {
+                pawnAttacks[0][s] |= 1ULL << (s + 8 + side);
+            }
+            if (onBoard(file + side, rank - 1))
+            {
+                pawnAttacks[1][s] |= 1ULL << (s - 8 + side);
+            }
+        }
+    }
+}
+
+static bitboard occupancy(const tbPosition *p, int colour)
+{
+    bitboard occupied = 0;
+    for (int i = 0; i < p->count; i++)
+    {
+        if (colour < 0 || (p->pieces[i] & EGTB_BLACK) == colour)
+        {
+            occupied |= 1ULL << p->squares[i];
+        }
+    }
+    return occupied;
+}
+
+static bool attacks(int piece, int from, int to, bitboard occupied)
+{
+    switch (piece & 7)
+    {
+    case EGTB_PAWN:
+        return pawnAttacks[piece >> 3][from] >> to & 1;
+    case EGTB_KNIGHT:
+        return knightAttacks[from] >> to & 1;
+    case EGTB_KING:
+        return kingAttacks[from] >> to & 1;
+    case EGTB_BISHOP:
+        return lineKind[from][to] == 2 && !(between[from][to] & occupied);
+    case EGTB_ROOK:
+        return lineKind[from][to] == 1 && !(between[from][to] & occupied);
+    default:
+        return lineKind[from][to] && !(between[from][to] & occupied);
+    }
+}
+
+static bool isKingAttackedBy(const tbPosition *p, int colour)
+{
+    bitboard occupied = occupancy(p, -1);
+    int king = -1;
+    for (int i = 0; i < p->count; i++)
+    {
+        if (p->pieces[i] == (EGTB_KING | (colour ^ EGTB_BLACK)))
+        {
+            king = p->squares[i];
+        }
+    }
+    for (int i = 0; i < p->count; i++)
+    {
+        if ((p->pieces[i] & EGTB_BLACK) == colour && attacks(p->pieces[i], p->squares[i], king, occupied))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// *********
+// children
+// *********
+
+static void addChild(const tbPosition *p, int slot, int to, int promotion, bool doublePush, tbChild *children,
+                     int *count)
+{
+    int colour = p->whiteToMove ? 0 : EGTB_BLACK;
+    tbChild *child = &children[*count];
+    tbPosition *c = &child->position;
+    *c = *p;
+    c->squares[slot] = to;
+    if (promotion)
+    {
+        c->pieces[slot] = promotion | colour;
+    }
+    bool captured = false;
+    for (int i = 0; i < c->count; i++)
+    {
+        if (i != slot && c->squares[i] == to)
+        {
+            for (int j = i; j < c->count - 1; j++)
+            {
+                c->pieces[j] = c->pieces[j + 1];
+                c->squares[j] = c->squares[j + 1];
+            }
+            c->count--;
+            captured = true;
+            break;
+        }
+    }
+    c->whiteToMove = !p->whiteToMove;
+    if (isKingAttackedBy(c, colour ^ EGTB_BLACK))
+    {
+        return; // leaves the own king in check
+    }
+    child->sameMaterial = !captured && !promotion;
+    child->doublePush = doublePush ? to : -1;
+    (*count)++;
+}
+
+static void addTargets(const tbPosition *p, int slot, bitboard targets, tbChild *children, int *count)
+{
+    while (targets)
+    {
+        addChild(p, slot, __builtin_ctzll(targets), 0, false, children, count);
+        targets &= targets - 1;
+    }
+}
+
+static void addPawnMove(const tbPosition *p, int slot, int to, tbChild *children, int *count)
+{
+    if ((to >> 3) == 0 || (to >> 3) == 7)
+    {
+        const int promotions[4] = {EGTB_QUEEN, EGTB_ROOK, EGTB_BISHOP, EGTB_KNIGHT};
+        for (int i = 0; i < 4; i++)
+        {
+            addChild(p, slot, to, promotions[i], false, children, count);
+        }
+    }
+    else
+    {
+        addChild(p, slot, to, 0, false, children, count);
+    }
+}
+
+// legal moves of the side to move, as the positions they lead to
+static int generateChildren(const tbPosition *p, tbChild *children)
+{
+    int count = 0;
+    int colour = p->whiteToMove ? 0 : EGTB_BLACK;
+    bitboard own = occupancy(p, colour);
+    bitboard occupied = occupancy(p, -1);
+    for (int slot = 0; slot < p->count; slot++)
+    {
+        int piece = p->pieces[slot];
+        int from = p->squares[slot];
+        if ((piece & EGTB_BLACK) != colour)
+        {
+            continue;
+        }
+        int kind = piece & 7;
+        if (kind == EGTB_KING)
+        {
+            addTargets(p, slot, kingAttacks[from] & ~own, children, &count);
+        }
+        else if (kind == EGTB_KNIGHT)
+        {
+            addTargets(p, slot, knightAttacks[from] & ~own, children, &count);
+        }
+        else if (kind == EGTB_PAWN)
+        {
+            int forward = colour ? -8 : 8;
+            int to = from + forward;
+            if (!(occupied >> to & 1))
+            {
+                addPawnMove(p, slot, to, children, &count);
+                if ((from >> 3) == (colour ? 6 : 1) && !(occupied >> (to + forward) & 1))
+                {
+                    addChild(p, slot, to + forward, 0, true, children, &count);
+                }
+            }
+            bitboard captures = pawnAttacks[colour >> 3][from] & occupied & ~own;
+            while (captures)
+            {
+                addPawnMove(p, slot, __builtin_ctzll(captures), children, &count);
+                captures &= captures - 1;
+            }
+        }
+        else
+        {
+            int first = kind == EGTB_BISHOP ? 4 : 0;
+            int last = kind == EGTB_ROOK ? 4 : 8;
+            bitboard targets = 0;
+            for (int d = first; d < last; d++)
+            {
+                for (int f = (from & 7) + directions[d][0], r = (from >> 3) + directions[d][1]; onBoard(f, r);
+                     f += directions[d][0], r += directions[d][1])
+                {
+                    targets |= 1ULL << (r * 8 + f);
+                    if (occupied >> (r * 8 + f) & 1)
+                    {
+                        break;
+                    }
+                }
+            }
+            addTargets(p, slot, targets & ~own, children, &count);
+        }
+    }
+    return count;
+}
+
+// ******
+// values
+// ******
+
+static int subTableValue(const tbPosition *p)
+{
+    bool found;
+    int value = egtbProbePieces(p->pieces, p->squares, p->count, p->whiteToMove, &found);
+    if (!found)
+    {
+        fprintf(stderr, "missing table for a capture or promotion\n");
+        exit(1);
+    }
+    return value;
+}
+
+static int betterValue(int a, int b)
+{
+    int rankA = EGTB_IS_WIN(a) ? 1000 - a : EGTB_IS_LOSS(a) ? -1000 + a : 0;
+    int rankB = EGTB_IS_WIN(b) ? 1000 - b : EGTB_IS_LOSS(b) ? -1000 + b : 0;
+    return rankA >= rankB ? a : b;
+}
+
+// best value the child's side to move gets by taking a pawn that just moved
+// two squares en passant. tables have no en passant rights, so this is
+// worked out here. false if no such capture exists
+static bool enPassantValue(const tbChild *child, int *value)
+{
+    const tbPosition *c = &child->position;
+    int colour = c->whiteToMove ? 0 : EGTB_BLACK;
+    int passed = child->doublePush;
+    int target = passed + (colour ? 8 : -8);
+    bool found = false;
+    for (int slot = 0; slot < c->count; slot++)
+    {
+        if (c->pieces[slot] != (EGTB_PAWN | colour) || !(pawnAttacks[colour >> 3][c->squares[slot]] >> target & 1))
+        {
+            continue;
+        }
+        tbPosition after = *c;
+        after.squares[slot] = target;
+        for (int i = 0; i < after.count; i++)
+        {
+            if (after.squares[i] == passed)
+            {
+                for (int j = i; j < after.count - 1; j++)
+                {
+                    after.pieces[j] = after.pieces[j + 1];
+                    after.squares[j] = after.squares[j + 1];
+                }
+                after.count--;
+                break;
+            }
+        }
+        after.whiteToMove = !c->whiteToMove;
+        if (isKingAttackedBy(&after, colour ^ EGTB_BLACK))
+        {
+            continue;
+        }
+        int afterValue = subTableValue(&after);
+        int capture = afterValue == EGTB_DRAW ? EGTB_DRAW : afterValue + 1;
+        *value = found ? betterValue(*value, capture) : capture;
+        found = true;
+    }
+    return found;
+}
+
+// value of a position in the table after `pass` passes, or UNSOLVED
+static uint8_t solve(generation *g, uint64_t index)
+{
+    tbPosition p;
+    p.count = g->material.count;
+    memcpy(p.pieces, g->material.pieces, sizeof(p.pieces));
+    egtbSquares(&g->material, index, p.squares, &p.whiteToMove);
+
+    if (g->pass == 0)
+    {
+        bitboard seen = 0;
+        for (int i = 0; i < p.count; i++)
+        {
+            int rank = p.squares[i] >> 3;
+            if ((seen >> p.squares[i] & 1) || ((p.pieces[i] & 7) == EGTB_PAWN && (rank == 0 || rank == 7)))
+            {
+                return SETTLED_DRAW;
+            }
+            seen |= 1ULL << p.squares[i];
+        }
+        if (isKingAttackedBy(&p, p.whiteToMove ? 0 : EGTB_BLACK))
+        {
+            return SETTLED_DRAW; // the side not to move is in check
+        }
+    }
+
+    tbChild children[MAX_CHILDREN];
+    int count = generateChildren(&p, children);
+    if (count == 0)
+    {
+        return isKingAttackedBy(&p, p.whiteToMove ? EGTB_BLACK : 0) ? 1 : SETTLED_DRAW;
+    }
+    if (g->pass == 0)
+    {
+        return UNSOLVED;
+    }
+
+    // odd passes look for a move to a position lost in fewer plies, even
+    // passes for positions where every move leads to a won one
+    bool lookingForWin = g->pass % 2 == 1;
+    int best = -1;
+    for (int i = 0; i < count; i++)
+    {
+        tbChild *child = &children[i];
+        int value;
+        if (child->sameMaterial)
+        {
+            value = g->current[egtbIndex(&g->material, child->position.whiteToMove, child->position.squares)];
+            value = value == SETTLED_DRAW ? EGTB_DRAW : value;
+        }
+        else
+        {
+            value = subTableValue(&child->position);
+        }
+
+        int capture = EGTB_DRAW;
+        bool hasCapture = child->doublePush >= 0 && enPassantValue(child, &capture);
+        if (lookingForWin)
+        {
+            // a loss for the child unless the en passant capture does better
+            if (!EGTB_IS_LOSS(value) || (hasCapture && !EGTB_IS_LOSS(capture)))
+            {
+                continue;
+            }
+            int plies = EGTB_PLIES(hasCapture ? betterValue(value, capture) : value);
+            if (plies <= g->pass - 1 && (best < 0 || plies < best))
+            {
+                best = plies;
+            }
+        }
+        else
+        {
+            // an unsolved table value is no win in fewer than pass plies, so
+            // a faster en passant win is already the child's value
+            int plies;
+            if (EGTB_IS_WIN(value))
+            {
+                plies = EGTB_PLIES(hasCapture ? betterValue(value, capture) : value);
+            }
+            else if (value == UNSOLVED && hasCapture && EGTB_IS_WIN(capture))
+            {
+                plies = EGTB_PLIES(capture);
+            }
+            else
+            {
+                return UNSOLVED;
+            }
+            if (plies > g->pass - 1)
+            {
+                return UNSOLVED;
+            }
+            best = plies > best ? plies : best;
+        }
+    }
+    if (best < 0 || best + 1 > MAX_TB_PLIES)
+    {
+        return UNSOLVED;
+    }
+    return (uint8_t)(best + 2);
+}
+
+// ***********
+// generation
+// ***********
+
+static void *passWorker(void *data)
+{
+    generation *g = (generation *)data;
+    uint64_t changed = 0;
+    uint64_t start;
+    while ((start = atomic_fetch_add(&g->nextChunk, CHUNK)) < g->material.size)
+    {
+        uint64_t end = start + CHUNK < g->material.size ? start + CHUNK : g->material.size;
+        for (uint64_t index = start; index < end; index++)
+        {
+            if (g->current[index] != UNSOLVED)
+            {
+                continue;
+            }
+            uint8_t value = solve(g, index);
+            if (value != UNSOLVED)
+            {
+                g->next[index] = value;
+                changed++;
+            }
+        }
+    }
+    atomic_fetch_add(&g->changed, changed);
+    return NULL;
+}
+
+static const int pieceValues[7] = {0, 1, 3, 3, 5, 9, 0};
+static const char pieceChars[] = " PNBRQK";
+
+// "K" plus the side's pieces from queens down to pawns
+static void sideString(const int *pieces, int count, int colour, char *out)
+{
+    int length = 0;
+    out[length++] = 'K';
+    for (int kind = EGTB_QUEEN; kind >= EGTB_PAWN; kind--)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            if (pieces[i] == (kind | colour))
+            {
+                out[length++] = pieceChars[kind];
+            }
+        }
+    }
+    out[length] = 0;
+}
+
+static int sideValue(const int *pieces, int count, int colour)
+{
+    int value = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if ((pieces[i] & EGTB_BLACK) == colour)
+        {
+            value += pieceValues[pieces[i] & 7];
+        }
+    }
+    return value;
+}
+
+// table name with the stronger side first
+static void canonicalName(const int *pieces, int count, char *name)
+{
+    char white[EGTB_MAX_PIECES + 1];
+    char black[EGTB_MAX_PIECES + 1];
+    sideString(pieces, count, 0, white);
+    sideString(pieces, count, EGTB_BLACK, black);
+    int whiteValue = sideValue(pieces, count, 0);
+    int blackValue = sideValue(pieces, count, EGTB_BLACK);
+    // equal values: the side with the earlier piece in queen to pawn order
+    bool swap = blackValue > whiteValue;
+    if (blackValue == whiteValue)
+    {
+        for (int i = 0; white[i] && black[i]; i++)
+        {
+            if (white[i] != black[i])
+            {
+                swap = strchr(pieceChars, black[i]) > strchr(pieceChars, white[i]);
+                break;
+            }
+        }
+    }
+    sprintf(name, "%s%s", swap ? black : white, swap ? white : black);
+}
+
+static bool tableLoaded(const egtbMaterial *material, int *maxPlies)
+{
+    // the table may also be stored with colours swapped
+    char white[EGTB_MAX_PIECES + 1];
+    char black[EGTB_MAX_PIECES + 1];
+    char swapped[2 * EGTB_MAX_PIECES + 1];
+    sideString(material->pieces, material->count, 0, white);
+    sideString(material->pieces, material->count, EGTB_BLACK, black);
+    snprintf(swapped, sizeof(swapped), "%s%s", black, white);
+    *maxPlies = egtbMaxPlies(material->name);
+    if (*maxPlies < 0)
+    {
+        *maxPlies = egtbMaxPlies(swapped);
+    }
+    return *maxPlies >= 0;
+}
+
+static bool generateTable(const char *directory, const char *name, int threads);
+
+// tables reached by captures and promotions, generated first. returns the
+// longest mate among them, -1 if one could not be made
+static int generateDependencies(const char *directory, const egtbMaterial *material, int threads)
+{
+    int longest = 0;
+    int count = material->count;
+    for (int i = 0; i < count; i++)
+    {
+        int kind = material->pieces[i] & 7;
+        if (kind == EGTB_KING)
+        {
+            continue;
+        }
+        int variants[EGTB_MAX_PIECES * 5][EGTB_MAX_PIECES];
+        int variantCounts[EGTB_MAX_PIECES * 5];
+        int variantCount = 0;
+
+        // piece i captured
+        for (int j = 0, k = 0; j < count; j++)
+        {
+            if (j != i)
+            {
+                variants[variantCount][k++] = material->pieces[j];
+            }
+        }
+        variantCounts[variantCount++] = count - 1;
+
+        // pawn i promoted, with or without capturing one of the other side's pieces
+        if (kind == EGTB_PAWN)
+        {
+            for (int promotion = EGTB_KNIGHT; promotion <= EGTB_QUEEN; promotion++)
+            {
+                memcpy(variants[variantCount], material->pieces, sizeof(int) * count);
+                variants[variantCount][i] = promotion | (material->pieces[i] & EGTB_BLACK);
+                variantCounts[variantCount++] = count;
+                for (int j = 0; j < count; j++)
+                {
+                    if ((material->pieces[j] & EGTB_BLACK) == (material->pieces[i] & EGTB_BLACK) ||
+                        (material->pieces[j] & 7) == EGTB_KING)
+                    {
+                        continue;
+                    }
+                    for (int k = 0, l = 0; k < count; k++)
+                    {
+                        if (k != j)
+                        {
+                            variants[variantCount][l++] = k == i ? promotion | (material->pieces[i] & EGTB_BLACK)
+                                                                 : material->pieces[k];
+                        }
+                    }
+                    variantCounts[variantCount++] = count - 1;
+                }
+            }
+        }
+
+        for (int v = 0; v < variantCount; v++)
+        {
+            if (variantCounts[v] < 3)
+            {
+                continue; // bare kings
+            }
+            char dependency[8];
+            egtbMaterial dependencyMaterial;
+            int plies;
+            canonicalName(variants[v], variantCounts[v], dependency);
+            egtbParseMaterial(dependency, &dependencyMaterial);
+            if (!tableLoaded(&dependencyMaterial, &plies))
+            {
+                if (!generateTable(directory, dependency, threads))
+                {
+                    return -1;
+                }
+                tableLoaded(&dependencyMaterial, &plies);
+            }
+            longest = plies > longest ? plies : longest;
+        }
+    }
+    return longest;
+}
+
+static bool writeTable(const char *directory, const generation *g, int maxPlies)
+{
+    char path[PATH_MAX + sizeof(g->material.name) + sizeof(EGTB_EXTENSION)];
+    char temporary[sizeof(path) + 4];
+    if (snprintf(path, sizeof(path), "%s/%s%s", directory, g->material.name, EGTB_EXTENSION) >= (int)sizeof(path))
+    {
+        fprintf(stderr, "table directory %s is too long\n", directory);
+        return false;
+    }
+    snprintf(temporary, sizeof(temporary), "%s.tmp", path);
+    FILE *file = fopen(temporary, "wb");
+    if (file == NULL)
+    {
+        return false;
+    }
+    uint8_t header[EGTB_HEADER_SIZE] = {0};
+    memcpy(header, "MEOWLTB1", 8);
+    memcpy(header + 8, g->material.name, strlen(g->material.name));
+    for (int i = 0; i < 8; i++)
+    {
+        header[16 + i] = (uint8_t)(g->material.size >> (8 * i));
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        header[24 + i] = (uint8_t)(maxPlies >> (8 * i));
+    }
+    bool ok = fwrite(header, 1, sizeof(header), file) == sizeof(header) &&
+              fwrite(g->current, 1, g->material.size, file) == g->material.size;
+    ok = fclose(file) == 0 && ok;
+    return ok && rename(temporary, path) == 0;
+}
+
+static bool generateTable(const char *directory, const char *name, int threads)
+{
+    generation g;
+    memset(&g, 0, sizeof(g));
+    if (!egtbParseMaterial(name, &g.material))
+    {
+        fprintf(stderr, "invalid table name %s\n", name);
+        return false;
+    }
+    int existing;
+    if (tableLoaded(&g.material, &existing))
+    {
+        return true;
+    }
+    int longestDependency = generateDependencies(directory, &g.material, threads);
+    if (longestDependency < 0)
+    {
+        return false;
+    }
+
+    int64_t start = getTimeMs();
+    g.current = (uint8_t *)calloc(g.material.size, 1);
+    g.next = (uint8_t *)calloc(g.material.size, 1);
+    pthread_t *workers = (pthread_t *)malloc(threads * sizeof(pthread_t));
+    int lastChange = 0;
+    for (g.pass = 0; g.pass <= MAX_TB_PLIES; g.pass++)
+    {
+        atomic_store(&g.nextChunk, 0);
+        atomic_store(&g.changed, 0);
+        for (int i = 0; i < threads; i++)
+        {
+            pthread_create(&workers[i], NULL, passWorker, &g);
+        }
+        for (int i = 0; i < threads; i++)
+        {
+            pthread_join(workers[i], NULL);
+        }
+        memcpy(g.current, g.next, g.material.size);
+        if (atomic_load(&g.changed) > 0)
+        {
+            lastChange = g.pass;
+        }
+        // mates through captures and promotions can settle late, so keep going
+        // until two passes in a row change nothing past the longest of those
+        if (g.pass > longestDependency + 1 && g.pass - lastChange >= 2)
+        {
+            break;
+        }
+    }
+    free(workers);
+
+    uint64_t wins = 0, losses = 0, draws = 0;
+    int maxPlies = 0;
+    for (uint64_t i = 0; i < g.material.size; i++)
+    {
+        uint8_t value = g.current[i];
+        if (value == SETTLED_DRAW || value == UNSOLVED)
+        {
+            g.current[i] = EGTB_DRAW;
+            draws++;
+            continue;
+        }
+        wins += EGTB_IS_WIN(value);
+        losses += EGTB_IS_LOSS(value);
+        maxPlies = EGTB_PLIES(value) > maxPlies ? EGTB_PLIES(value) : maxPlies;
+    }
+
+    bool ok = writeTable(directory, &g, maxPlies);
+    free(g.current);
+    free(g.next);
+    if (!ok)
+    {
+        fprintf(stderr, "could not write %s to %s\n", name, directory);
+        return false;
+    }
+    printf("%-6s %10llu positions  %9llu wins  %9llu losses  %9llu draws/illegal  longest mate %3d plies  %lld ms\n",
+           name, (unsigned long long)g.material.size, (unsigned long long)wins, (unsigned long long)losses,
+           (unsigned long long)draws, maxPlies, (long long)(getTimeMs() - start));
+    fflush(stdout);
+    egtbInit(directory);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "usage: %s directory [--threads N] [all | KQK KRK KPK ...]\n", argv[0]);
+        return 1;
+    }
+    const char *directory = argv[1];
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    initAttacks();
+    egtbInit(directory);
+
+    char names[64][8];
+    int nameCount = 0;
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            threads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "all") == 0)
+        {
+            // every 3 and 4 piece ending
+            for (int a = EGTB_PAWN; a <= EGTB_QUEEN; a++)
+            {
+                int three[3] = {EGTB_KING, a, EGTB_KING | EGTB_BLACK};
+                canonicalName(three, 3, names[nameCount++]);
+                for (int b = EGTB_PAWN; b <= a; b++)
+                {
+                    int sameSide[4] = {EGTB_KING, a, b, EGTB_KING | EGTB_BLACK};
+                    int otherSide[4] = {EGTB_KING, a, EGTB_KING | EGTB_BLACK, b | EGTB_BLACK};
+                    canonicalName(sameSide, 4, names[nameCount++]);
+                    canonicalName(otherSide, 4, names[nameCount++]);
+                }
+            }
+        }
+        else if (nameCount < 64)
+        {
+            snprintf(names[nameCount++], sizeof(names[0]), "%s", argv[i]);
+        }
+    }
+    if (threads < 1)
+    {
+        threads = 1;
+    }
+
+    for (int i = 0; i < nameCount; i++)
+    {
+        if (!generateTable(directory, names[i], threads))
+        {
+            return 1;
+        }
+    }
+    egtbFree();
+    return 0;
+}
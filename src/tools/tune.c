@@ -0,0 +1,570 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "search.h"
+#include "eval.h"
+#include "fen.h"
+#include "dataset.h"
+#include "pawns.h"
+#include "material.h"
+
+// Texel tuning of the evaluation weights: minimises the squared error between
+// the game results of a labelled position set and sigmoid(K * evaluate()).
+// the evaluation is linear in its weights, so every position is stored as the
+// list of weights its pieces use plus its material and pawn structure counts,
+// and the gradient is exact. endgames with their own evaluator or scale (see
+// material.h) are not linear and are left out. positions are
+// split between threads, each summing its own gradient.
+//
+//   tune positions.txt [--threads N] [--epochs N] [--rate R] [--quiet] [--out file.h]
+//
+// a line is a FEN followed by the result of its game, as 1-0 / 0-1 / 1/2-1/2
+// or as a score from white's side: [1.0] [0.5] [0.0]. dataset files (see
+// dataset.h) are read directly instead of being parsed. --quiet first replaces
+// every position with the end of its quiescence search's best line
+
+#define DATA_LINE 512
+#define PIECE_KINDS 6 // pawn, knight, bishop, rook, queen, king
+#define VALUE_WEIGHTS 5
+#define MATERIAL_WEIGHTS (VALUE_WEIGHTS + PIECE_KINDS * 64) // first imbalance weight
+#define PAWN_WEIGHTS (MATERIAL_WEIGHTS + MATERIAL_FEATURES)  // first pawn structure weight
+#define MOBILITY_WEIGHT (PAWN_WEIGHTS + PAWN_FEATURES)
+#define WEIGHT_COUNT (MOBILITY_WEIGHT + 1)
+#define MAX_PIECES 32
+
+// a piece is kind (3 bits) | black (1 bit) | square (6 bits)
+typedef struct
+{
+    float result; // 1 white won, 0.5 draw, 0 black won
+    uint8_t count;
+    uint16_t pieces[MAX_PIECES];
+    int8_t material[MATERIAL_FEATURES]; // materialFeatures, white minus black
+    int8_t pawns[PAWN_FEATURES];         // pawnFeatures, white minus black
+    int8_t mobility;                     // mobilityFeature, white minus black
+} tuningPosition;
+
+typedef struct
+{
+    tuningPosition *positions;
+    int count;
+    int threads;
+    double weights[WEIGHT_COUNT];
+    double k;
+
+    // per pass
+    bool wantGradient;
+    double *gradients; // threads x WEIGHT_COUNT
+    double *errors;    // per thread
+} tuner;
+
+typedef struct
+{
+    tuner *tuner;
+    int index;
+} tuningWorker;
+
+// *********
+// features
+// *********
+
+// weight index of the piece value and of the piece-square entry, the sign is
+// +1 for white and -1 for black
+static void pieceWeights(uint16_t piece, int *value, int *table, int *sign)
+{
+    int kind = piece >> 7;
+    int black = piece >> 6 & 1;
+    int square = piece & 63;
+    int rank = square / 8;
+    int file = square % 8;
+    *value = kind < VALUE_WEIGHTS ? kind : -1;
+    *table = VALUE_WEIGHTS + kind * 64 + (black ? rank : 7 - rank) * 8 + file;
+    *sign = black ? -1 : 1;
+}
+
+// evaluation from white's side
+static double linearEval(const tuningPosition *position, const double *weights)
+{
+    double score = 0;
+    for (int i = 0; i < position->count; i++)
+    {
+        int value, table, sign;
+        pieceWeights(position->pieces[i], &value, &table, &sign);
+        score += sign * (weights[table] + (value >= 0 ? weights[value] : 0));
+    }
+    for (int i = 0; i < MATERIAL_FEATURES; i++)
+    {
+        score += position->material[i] * weights[MATERIAL_WEIGHTS + i];
+    }
+    for (int i = 0; i < PAWN_FEATURES; i++)
+    {
+        score += position->pawns[i] * weights[PAWN_WEIGHTS + i];
+    }
+    score += position->mobility * weights[MOBILITY_WEIGHT];
+    return score;
+}
+
+static void encodePosition(game position, tuningPosition *out)
+{
+    const bitboard kinds[PIECE_KINDS] = {position.board.pawn, position.board.knight, position.board.bishop,
+                                         position.board.rook, position.board.queen,  position.board.king};
+    out->count = 0;
+    for (int kind = 0; kind < PIECE_KINDS; kind++)
+    {
+        for (bitboard bits = kinds[kind]; bits && out->count < MAX_PIECES; bits &= bits - 1)
+        {
+            int square = trailingZeros(bits);
+            int black = !(position.board.white >> square & 1);
+            out->pieces[out->count++] = (uint16_t)(kind << 7 | black << 6 | square);
+        }
+    }
+    int material[MATERIAL_FEATURES];
+    materialFeatures(position.board, material);
+    for (int i = 0; i < MATERIAL_FEATURES; i++)
+    {
+        out->material[i] = (int8_t)material[i];
+    }
+    int pawns[PAWN_FEATURES];
+    pawnFeatures(position.board, pawns);
+    for (int i = 0; i < PAWN_FEATURES; i++)
+    {
+        out->pawns[i] = (int8_t)pawns[i];
+    }
+    out->mobility = (int8_t)mobilityFeature(position.board);
+}
+
+static void initialWeights(double *weights)
+{
+    const int values[VALUE_WEIGHTS] = {PAWN_VALUE, KNIGHT_VALUE, BISHOP_VALUE, ROOK_VALUE, QUEEN_VALUE};
+    const int tables[PIECE_KINDS][64] = {PAWN_TABLE, KNIGHT_TABLE, BISHOP_TABLE, ROOK_TABLE, QUEEN_TABLE, KING_TABLE};
+    for (int i = 0; i < VALUE_WEIGHTS; i++)
+    {
+        weights[i] = values[i];
+    }
+    for (int kind = 0; kind < PIECE_KINDS; kind++)
+    {
+        for (int i = 0; i < 64; i++)
+        {
+            weights[VALUE_WEIGHTS + kind * 64 + i] = tables[kind][i];
+        }
+    }
+    weights[MATERIAL_WEIGHTS + MATERIAL_BISHOP_PAIR] = BISHOP_PAIR;
+    weights[MATERIAL_WEIGHTS + MATERIAL_KNIGHT_PAWNS] = KNIGHT_PAWNS;
+    weights[MATERIAL_WEIGHTS + MATERIAL_ROOK_PAWNS] = ROOK_PAWNS;
+    const int passed[8] = PASSED_PAWN_TABLE;
+    weights[PAWN_WEIGHTS + PAWN_DOUBLED] = DOUBLED_PAWN;
+    weights[PAWN_WEIGHTS + PAWN_ISOLATED] = ISOLATED_PAWN;
+    for (int rank = 0; rank < 8; rank++)
+    {
+        weights[PAWN_WEIGHTS + PAWN_PASSED + rank] = passed[rank];
+    }
+    weights[MOBILITY_WEIGHT] = MOBILITY;
+}
+
+// ********
+// loading
+// ********
+
+// result of the game from the text after the FEN, -1 if there is none
+static float parseResult(const char *text)
+{
+    const char *bracket = strchr(text, '[');
+    if (bracket != NULL)
+    {
+        return strtof(bracket + 1, NULL);
+    }
+    if (strstr(text, "1/2-1/2") != NULL)
+    {
+        return 0.5f;
+    }
+    if (strstr(text, "1-0") != NULL)
+    {
+        return 1.0f;
+    }
+    if (strstr(text, "0-1") != NULL)
+    {
+        return 0.0f;
+    }
+    return -1;
+}
+
+static bool loadDataset(tuner *t, const dataset *set, game **games)
+{
+    t->positions = (tuningPosition *)malloc(set->count * sizeof(tuningPosition));
+    *games = (game *)malloc(set->count * sizeof(game));
+    for (uint64_t i = 0; i < set->chunkCount; i++)
+    {
+        const trainingRecord *records = (const trainingRecord *)(set->data + set->chunks[i].offset);
+        for (uint32_t j = 0; j < set->chunks[i].count; j++)
+        {
+            unpackPosition(&records[j].position, &(*games)[t->count]);
+            t->positions[t->count].result = records[j].result / 2.0f;
+            t->count++;
+        }
+    }
+    return t->count > 0;
+}
+
+static bool loadPositions(tuner *t, const char *path, game **games)
+{
+    dataset set;
+    if (openDataset(&set, path))
+    {
+        bool loaded = loadDataset(t, &set, games);
+        closeDataset(&set);
+        return loaded;
+    }
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        fprintf(stderr, "could not open %s\n", path);
+        return false;
+    }
+    int capacity = 1 << 16;
+    t->positions = (tuningPosition *)malloc(capacity * sizeof(tuningPosition));
+    *games = (game *)malloc(capacity * sizeof(game));
+    char line[DATA_LINE];
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        game position;
+        const char *rest = parseFen(&position, line);
+        float result = rest != NULL ? parseResult(rest) : -1;
+        if (result < 0 || result > 1)
+        {
+            continue;
+        }
+        if (t->count == capacity)
+        {
+            capacity *= 2;
+            t->positions = (tuningPosition *)realloc(t->positions, capacity * sizeof(tuningPosition));
+            *games = (game *)realloc(*games, capacity * sizeof(game));
+        }
+        t->positions[t->count].result = result;
+        (*games)[t->count] = position;
+        t->count++;
+    }
+    fclose(file);
+    return t->count > 0;
+}
+
+// ******
+// passes
+// ******
+
+typedef struct
+{
+    tuner *tuner;
+    game *games;
+    bool quiet;
+    atomic_int next;
+} encodeJob;
+
+static void *encodeWorker(void *data)
+{
+    encodeJob *job = (encodeJob *)data;
+    int index;
+    while ((index = atomic_fetch_add(&job->next, 1)) < job->tuner->count)
+    {
+        game position = job->quiet ? quietPosition(job->games[index]) : job->games[index];
+        encodePosition(position, &job->tuner->positions[index]);
+        if (usesEndgameRules(position))
+        {
+            job->tuner->positions[index].count = 0; // dropped once all are encoded
+        }
+    }
+    return NULL;
+}
+
+static double sigmoid(double k, double score)
+{
+    return 1 / (1 + pow(10, -k * score / 400));
+}
+
+// error (and gradient) over this thread's share of the positions
+static void *passWorker(void *data)
+{
+    tuningWorker *worker = (tuningWorker *)data;
+    tuner *t = worker->tuner;
+    double *gradient = t->gradients + (size_t)worker->index * WEIGHT_COUNT;
+    int start = (int)((int64_t)t->count * worker->index / t->threads);
+    int end = (int)((int64_t)t->count * (worker->index + 1) / t->threads);
+    double error = 0;
+    memset(gradient, 0, WEIGHT_COUNT * sizeof(double));
+    for (int i = start; i < end; i++)
+    {
+        const tuningPosition *position = &t->positions[i];
+        double predicted = sigmoid(t->k, linearEval(position, t->weights));
+        double difference = position->result - predicted;
+        error += difference * difference;
+        if (!t->wantGradient)
+        {
+            continue;
+        }
+        // d(error)/d(score), the weights then only scale it by +1 or -1
+        double slope = -2 * difference * predicted * (1 - predicted) * t->k * log(10) / 400;
+        for (int p = 0; p < position->count; p++)
+        {
+            int value, table, sign;
+            pieceWeights(position->pieces[p], &value, &table, &sign);
+            gradient[table] += sign * slope;
+            if (value >= 0)
+            {
+                gradient[value] += sign * slope;
+            }
+        }
+        for (int m = 0; m < MATERIAL_FEATURES; m++)
+        {
+            gradient[MATERIAL_WEIGHTS + m] += position->material[m] * slope;
+        }
+        for (int p = 0; p < PAWN_FEATURES; p++)
+        {
+            gradient[PAWN_WEIGHTS + p] += position->pawns[p] * slope;
+        }
+        gradient[MOBILITY_WEIGHT] += position->mobility * slope;
+    }
+    t->errors[worker->index] = error;
+    return NULL;
+}
+
+// mean squared error, gradient summed over the threads into gradient if not NULL
+static double runPass(tuner *t, double *gradient)
+{
+    pthread_t *threads = (pthread_t *)malloc(t->threads * sizeof(pthread_t));
+    tuningWorker *workers = (tuningWorker *)malloc(t->threads * sizeof(tuningWorker));
+    t->wantGradient = gradient != NULL;
+    for (int i = 0; i < t->threads; i++)
+    {
+        workers[i] = (tuningWorker){t, i};
+        pthread_create(&threads[i], NULL, passWorker, &workers[i]);
+    }
+    double error = 0;
+    for (int i = 0; i < t->threads; i++)
+    {
+        pthread_join(threads[i], NULL);
+        error += t->errors[i];
+    }
+    if (gradient != NULL)
+    {
+        memset(gradient, 0, WEIGHT_COUNT * sizeof(double));
+        for (int i = 0; i < t->threads; i++)
+        {
+            for (int w = 0; w < WEIGHT_COUNT; w++)
+            {
+                gradient[w] += t->gradients[(size_t)i * WEIGHT_COUNT + w] / t->count;
+            }
+        }
+    }
+    free(threads);
+    free(workers);
+    return error / t->count;
+}
+
+// the scaling constant that best fits the starting weights, by ternary search
+static void fitK(tuner *t)
+{
+    double low = 0.01;
+    double high = 3.0;
+    for (int i = 0; i < 40; i++)
+    {
+        double third = (high - low) / 3;
+        t->k = low + third;
+        double errorLow = runPass(t, NULL);
+        t->k = high - third;
+        double errorHigh = runPass(t, NULL);
+        if (errorLow < errorHigh)
+        {
+            high -= third;
+        }
+        else
+        {
+            low += third;
+        }
+    }
+    t->k = (low + high) / 2;
+}
+
+// ******
+// output
+// ******
+
+static bool writeWeights(const char *path, const double *weights)
+{
+    const char *valueNames[VALUE_WEIGHTS] = {"PAWN_VALUE", "KNIGHT_VALUE", "BISHOP_VALUE", "ROOK_VALUE",
+                                             "QUEEN_VALUE"};
+    const char *tableNames[PIECE_KINDS] = {"PAWN_TABLE", "KNIGHT_TABLE", "BISHOP_TABLE",
+                                           "ROOK_TABLE", "QUEEN_TABLE",  "KING_TABLE"};
+    FILE *file = fopen(path, "w");
+    if (file == NULL)
+    {
+        fprintf(stderr, "could not write %s\n", path);
+        return false;
+    }
+    fprintf(file, "// evaluation weights, generated by src/tools/tune.c (make build_tune). edit by\n");
+    fprintf(file, "// hand only to change the starting point of the next tuning run\n");
+    fprintf(file, "#ifndef MEOWL_WEIGHTS_H\n#define MEOWL_WEIGHTS_H\n\n");
+    for (int i = 0; i < VALUE_WEIGHTS; i++)
+    {
+        fprintf(file, "#define %s %d\n", valueNames[i], (int)lround(weights[i]));
+    }
+    fprintf(file, "\n// material imbalance: a bishop pair, and per knight or rook for each own pawn above 5\n");
+    fprintf(file, "#define BISHOP_PAIR %d\n", (int)lround(weights[MATERIAL_WEIGHTS + MATERIAL_BISHOP_PAIR]));
+    fprintf(file, "#define KNIGHT_PAWNS %d\n", (int)lround(weights[MATERIAL_WEIGHTS + MATERIAL_KNIGHT_PAWNS]));
+    fprintf(file, "#define ROOK_PAWNS %d\n", (int)lround(weights[MATERIAL_WEIGHTS + MATERIAL_ROOK_PAWNS]));
+    fprintf(file, "\n// pawn structure, per pawn. passed pawns by rank from their own side, rank 1 first\n");
+    fprintf(file, "#define DOUBLED_PAWN %d\n", (int)lround(weights[PAWN_WEIGHTS + PAWN_DOUBLED]));
+    fprintf(file, "#define ISOLATED_PAWN %d\n", (int)lround(weights[PAWN_WEIGHTS + PAWN_ISOLATED]));
+    fprintf(file, "#define PASSED_PAWN_TABLE {");
+    for (int rank = 0; rank < 8; rank++)
+    {
+        fprintf(file, "%d%s", (int)lround(weights[PAWN_WEIGHTS + PAWN_PASSED + rank]), rank < 7 ? ", " : "}\n");
+    }
+    fprintf(file, "\n// mobility, per attacked square not taken by an own piece\n");
+    fprintf(file, "#define MOBILITY %d\n", (int)lround(weights[MOBILITY_WEIGHT]));
+    fprintf(file, "\n// piece-square bonuses as seen from white's side, rank 8 first\n");
+    for (int kind = 0; kind < PIECE_KINDS; kind++)
+    {
+        fprintf(file, "#define %s \\\n    { \\\n", tableNames[kind]);
+        for (int rank = 0; rank < 8; rank++)
+        {
+            fprintf(file, "        ");
+            for (int column = 0; column < 8; column++)
+            {
+                int value = (int)lround(weights[VALUE_WEIGHTS + kind * 64 + rank * 8 + column]);
+                fprintf(file, "%d%s", value, column < 7 ? ", " : rank < 7 ? ", \\\n" : " \\\n");
+            }
+        }
+        fprintf(file, "    }\n\n");
+    }
+    fprintf(file, "#endif\n");
+    return fclose(file) == 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s positions.txt [--threads N] [--epochs N] [--rate R] [--quiet] [--out file.h]\n",
+                argv[0]);
+        return 1;
+    }
+    tuner t;
+    memset(&t, 0, sizeof(t));
+    t.threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int epochs = 300;
+    double rate = 1.0;
+    bool quiet = false;
+    const char *out = "src/core/weights.h";
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--quiet") == 0)
+        {
+            quiet = true;
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--threads") == 0)
+        {
+            t.threads = atoi(argv[++i]);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--epochs") == 0)
+        {
+            epochs = atoi(argv[++i]);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--rate") == 0)
+        {
+            rate = atof(argv[++i]);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--out") == 0)
+        {
+            out = argv[++i];
+        }
+    }
+    if (t.threads < 1)
+    {
+        t.threads = 1;
+    }
+
+    int64_t start = getTimeMs();
+    game *games;
+    if (!loadPositions(&t, argv[1], &games))
+    {
+        fprintf(stderr, "no labelled positions in %s\n", argv[1]);
+        return 1;
+    }
+    encodeJob job = {.tuner = &t, .games = games, .quiet = quiet};
+    atomic_init(&job.next, 0);
+    pthread_t *threads = (pthread_t *)malloc(t.threads * sizeof(pthread_t));
+    for (int i = 0; i < t.threads; i++)
+    {
+        pthread_create(&threads[i], NULL, encodeWorker, &job);
+    }
+    for (int i = 0; i < t.threads; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    int kept = 0;
+    for (int i = 0; i < t.count; i++)
+    {
+        if (t.positions[i].count > 0)
+        {
+            t.positions[kept] = t.positions[i];
+            games[kept++] = games[i];
+        }
+    }
+    t.count = kept;
+
+    // the linear model has to match the engine's evaluation exactly
+    initialWeights(t.weights);
+    for (int i = 0; i < t.count && i < 1000; i++)
+    {
+        game position = quiet ? quietPosition(games[i]) : games[i];
+        int engine = evaluate(position) * (position.metadata & WHITE_TO_MOVE ? 1 : -1);
+        if ((int)lround(linearEval(&t.positions[i], t.weights)) != engine)
+        {
+            fprintf(stderr, "the tuner's model does not match evaluate(), update tune.c with eval.c\n");
+            return 1;
+        }
+    }
+    free(games);
+    printf("%d positions loaded in %lld ms\n", t.count, (long long)(getTimeMs() - start));
+
+    t.gradients = (double *)malloc((size_t)t.threads * WEIGHT_COUNT * sizeof(double));
+    t.errors = (double *)malloc(t.threads * sizeof(double));
+    fitK(&t);
+    printf("K = %.4f, starting error %.6f\n", t.k, runPass(&t, NULL));
+
+    // Adam, the step size is roughly rate centipawns per epoch
+    double gradient[WEIGHT_COUNT];
+    double moment[WEIGHT_COUNT] = {0};
+    double velocity[WEIGHT_COUNT] = {0};
+    const double beta1 = 0.9, beta2 = 0.999;
+    for (int epoch = 1; epoch <= epochs; epoch++)
+    {
+        double error = runPass(&t, gradient);
+        for (int w = 0; w < WEIGHT_COUNT; w++)
+        {
+            moment[w] = beta1 * moment[w] + (1 - beta1) * gradient[w];
+            velocity[w] = beta2 * velocity[w] + (1 - beta2) * gradient[w] * gradient[w];
+            double correctedMoment = moment[w] / (1 - pow(beta1, epoch));
+            double correctedVelocity = velocity[w] / (1 - pow(beta2, epoch));
+            t.weights[w] -= rate * correctedMoment / (sqrt(correctedVelocity) + 1e-8);
+        }
+        if (epoch % 10 == 0 || epoch == epochs)
+        {
+            printf("epoch %4d  error %.6f  %lld ms\n", epoch, error, (long long)(getTimeMs() - start));
+            fflush(stdout);
+        }
+    }
+    printf("final error %.6f\n", runPass(&t, NULL));
+
+    bool ok = writeWeights(out, t.weights);
+    if (ok)
+    {
+        printf("weights written to %s, rebuild to use them\n", out);
+    }
+    free(t.gradients);
+    free(t.errors);
+    free(t.positions);
+    return ok ? 0 : 1;
+}